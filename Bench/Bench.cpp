@@ -0,0 +1,120 @@
+#include "Bench.h"
+#include <algorithm>
+#include <chrono>
+#include <cmath>
+#include <cstdio>
+#include <fstream>
+#include <iterator>
+#include <stdexcept>
+
+static double Percentile(const std::vector<double>& sorted, double fraction) {
+    // Nearest-rank percentile
+    size_t rank = (size_t)std::ceil(fraction * sorted.size());
+    return sorted[std::clamp<size_t>(rank, 1, sorted.size()) - 1];
+}
+
+BenchResult RunBenchmark(const Benchmark& benchmark, const std::string& corpusName, const std::vector<uint8_t>& corpus,
+    const BenchSettings& settings) {
+    using Clock = std::chrono::steady_clock;
+    BenchCase benchCase = benchmark.prepare(corpus);
+
+    // Warm-up run fills caches and lazily initialized tables
+    if (benchCase.setup) {
+        benchCase.setup();
+    }
+    benchCase.run();
+
+    std::vector<double> samples;
+    double total = 0;
+    while (samples.size() < settings.maxIterations
+        && (samples.size() < settings.minIterations || total < settings.minSeconds * 1e9)) {
+        if (benchCase.setup) {
+            benchCase.setup();
+        }
+
+        Clock::time_point begin = Clock::now();
+        benchCase.run();
+        double elapsed = (double)std::chrono::duration_cast<std::chrono::nanoseconds>(Clock::now() - begin).count();
+        samples.push_back(elapsed);
+        total += elapsed;
+    }
+
+    std::sort(samples.begin(), samples.end());
+    BenchResult result;
+    result.name = benchmark.name;
+    result.corpus = corpusName;
+    result.size = corpus.size();
+    result.iterations = samples.size();
+    result.meanNs = total / samples.size();
+    result.p50Ns = Percentile(samples, 0.50);
+    result.p90Ns = Percentile(samples, 0.90);
+    result.p99Ns = Percentile(samples, 0.99);
+    return result;
+}
+
+// One result object per line
+void WriteJson(const std::filesystem::path& path, const std::vector<BenchResult>& results) {
+    std::ofstream output(path, std::ios::trunc);
+    if (!output.is_open()) {
+        throw std::runtime_error("Error opening file for writing.");
+    }
+
+    output << "{\n  \"results\": [\n";
+    for (size_t i = 0; i < results.size(); ++i) {
+        const BenchResult& r = results[i];
+        char line[512];
+        std::snprintf(line, sizeof(line),
+            "    {\"name\": \"%s\", \"corpus\": \"%s\", \"size\": %zu, \"iterations\": %zu, "
+            "\"mean_ns\": %.1f, \"p50_ns\": %.1f, \"p90_ns\": %.1f, \"p99_ns\": %.1f, "
+            "\"mb_per_s\": %.3f, \"ns_per_byte\": %.3f, \"ops_per_s\": %.3f}%s\n",
+            r.name.c_str(), r.corpus.c_str(), r.size, r.iterations,
+            r.meanNs, r.p50Ns, r.p90Ns, r.p99Ns,
+            r.MegabytesPerSecond(), r.NsPerByte(), r.OpsPerSecond(),
+            i + 1 < results.size() ? "," : "");
+        output << line;
+    }
+    output << "  ]\n}\n";
+}
+
+static std::string JsonField(const std::string& object, const std::string& key) {
+    size_t pos = object.find("\"" + key + "\"");
+    if (pos == std::string::npos || (pos = object.find(':', pos + key.size() + 2)) == std::string::npos) {
+        throw std::runtime_error("Baseline result is missing \"" + key + "\".");
+    }
+
+    pos = object.find_first_not_of(" \t\r\n\"", pos + 1);
+    size_t end = object.find_first_of(",}\" \t\r\n", pos);
+    return object.substr(pos, end - pos);
+}
+
+// Any layout of the flat result objects, not only the one-per-line form WriteJson produces
+std::vector<BenchResult> ReadJson(const std::filesystem::path& path) {
+    std::ifstream input(path);
+    if (!input.is_open()) {
+        throw std::runtime_error("Error opening file.");
+    }
+
+    std::string text((std::istreambuf_iterator<char>(input)), std::istreambuf_iterator<char>());
+    std::vector<BenchResult> results;
+    for (size_t pos = text.find("\"mean_ns\""); pos != std::string::npos; pos = text.find("\"mean_ns\"", pos + 1)) {
+        size_t begin = text.rfind('{', pos);
+        size_t end = text.find('}', pos);
+        if (begin == std::string::npos || end == std::string::npos) {
+            throw std::runtime_error("Malformed baseline.");
+        }
+
+        std::string object = text.substr(begin, end - begin + 1);
+        BenchResult r;
+        r.name = JsonField(object, "name");
+        r.corpus = JsonField(object, "corpus");
+        r.size = std::stoull(JsonField(object, "size"));
+        r.iterations = std::stoull(JsonField(object, "iterations"));
+        r.meanNs = std::stod(JsonField(object, "mean_ns"));
+        r.p50Ns = std::stod(JsonField(object, "p50_ns"));
+        r.p90Ns = std::stod(JsonField(object, "p90_ns"));
+        r.p99Ns = std::stod(JsonField(object, "p99_ns"));
+        results.push_back(r);
+    }
+
+    return results;
+}
@@ -0,0 +1,55 @@
+#pragma once
+#include <cstddef>
+#include <cstdint>
+#include <filesystem>
+#include <functional>
+#include <string>
+#include <vector>
+
+// Prepared run of one benchmark over one corpus: setup is untimed and runs before every timed call
+struct BenchCase {
+    std::function<void()> setup;
+    std::function<void()> run;
+};
+
+struct Benchmark {
+    std::string name;
+    std::function<BenchCase(const std::vector<uint8_t>& corpus)> prepare;
+    // Caps the corpus size for algorithms that are quadratic in practice (0 = no limit)
+    size_t maxSize = 0;
+};
+
+struct BenchResult {
+    std::string name;
+    std::string corpus;
+    size_t size = 0;
+    size_t iterations = 0;
+    double meanNs = 0;
+    double p50Ns = 0;
+    double p90Ns = 0;
+    double p99Ns = 0;
+
+    double MegabytesPerSecond() const {
+        return size / (meanNs / 1e9) / (1024.0 * 1024.0);
+    }
+
+    double NsPerByte() const {
+        return size == 0 ? 0 : meanNs / size;
+    }
+
+    double OpsPerSecond() const {
+        return 1e9 / meanNs;
+    }
+};
+
+struct BenchSettings {
+    size_t minIterations = 5;
+    size_t maxIterations = 1000;
+    double minSeconds = 0.25;
+};
+
+BenchResult RunBenchmark(const Benchmark& benchmark, const std::string& corpusName, const std::vector<uint8_t>& corpus,
+    const BenchSettings& settings);
+
+void WriteJson(const std::filesystem::path& path, const std::vector<BenchResult>& results);
+std::vector<BenchResult> ReadJson(const std::filesystem::path& path);
@@ -0,0 +1,323 @@
+#include <A5Encoder.h>
+#include <Bmp.h>
+#include <Cipher.h>
+#include <HashMD2.h>
+#include <Lzss.h>
+#include <LzssSearch.h>
+#include <Rsa.h>
+#include <Utils.h>
+#include <algorithm>
+#include <cmath>
+#include <cstdio>
+#include <cstring>
+#include <functional>
+#include <map>
+#include <memory>
+#include <random>
+#include <stdexcept>
+#include <string>
+#include <vector>
+
+#include "Bench.h"
+
+constexpr const char* kAlphabet = "abcdefghijklmnopqrstuvwxyz ";
+constexpr size_t kDefaultSizes[] = { 1024, 16 * 1024, 256 * 1024 };
+constexpr double kDefaultThreshold = 0.10;
+
+static std::vector<uint8_t> MakeRandom(size_t size) {
+    std::mt19937 random(42);
+    std::vector<uint8_t> data(size);
+    for (uint8_t& byte : data) {
+        byte = (uint8_t)random();
+    }
+
+    return data;
+}
+
+// Words from a small vocabulary with a skewed distribution, roughly like logs or prose
+static std::vector<uint8_t> MakeText(size_t size) {
+    static const char* kWords[] = {
+        "the", "of", "and", "to", "in", "a", "is", "that", "for", "it", "as", "was", "with", "be", "by",
+        "on", "not", "he", "this", "are", "or", "his", "from", "at", "which", "but", "have", "an", "had",
+        "they", "you", "were", "their", "one", "all", "we", "can", "her", "has", "there", "been", "if",
+        "more", "when", "will", "would", "who", "so", "no", "message", "encrypted", "window", "palette"
+    };
+    constexpr size_t kWordCount = sizeof(kWords) / sizeof(kWords[0]);
+    std::mt19937 random(42);
+    std::geometric_distribution<size_t> pick(0.08);
+    std::vector<uint8_t> data;
+    data.reserve(size + 16);
+    while (data.size() < size) {
+        const char* word = kWords[pick(random) % kWordCount];
+        data.insert(data.end(), word, word + strlen(word));
+        data.push_back(random() % 12 == 0 ? '\n' : ' ');
+    }
+
+    data.resize(size);
+    return data;
+}
+
+static std::vector<uint8_t> MakeRepetitive(size_t size) {
+    static const char kPattern[] = "never gonna give you up ";
+    std::vector<uint8_t> data(size);
+    for (size_t i = 0; i < size; ++i) {
+        data[i] = kPattern[i % (sizeof(kPattern) - 1)];
+    }
+
+    return data;
+}
+
+// 8-bit square-ish cover whose pixels come from the corpus, with a message that fills it up to 4096 letters
+static std::vector<uint8_t> MakeCover(const std::vector<uint8_t>& corpus, uint32_t colors) {
+    uint32_t width = std::max<uint32_t>(4, (uint32_t)std::sqrt((double)corpus.size()));
+    uint32_t height = std::max<uint32_t>(1, (uint32_t)(corpus.size() / width));
+    uint32_t stride = (width + 3) / 4 * 4;
+    uint32_t offset = sizeof(BMPFileHeader) + sizeof(BMPInfoHeader) + colors * sizeof(uint32_t);
+    std::vector<uint8_t> data(offset + (size_t)stride * height);
+    auto fileHeader = reinterpret_cast<BMPFileHeader*>(data.data());
+    auto infoHeader = reinterpret_cast<BMPInfoHeader*>(data.data() + sizeof(BMPFileHeader));
+    memcpy(fileHeader->signature, "BM", 2);
+    fileHeader->size = (uint32_t)data.size();
+    fileHeader->offset = offset;
+    infoHeader->headerSize = sizeof(BMPInfoHeader);
+    infoHeader->width = width;
+    infoHeader->height = height;
+    infoHeader->planes = 1;
+    infoHeader->depth = 8;
+    infoHeader->colorsUsed = colors;
+    infoHeader->colorsImportant = colors;
+    for (size_t i = 0; i < (size_t)stride * height; ++i) {
+        data[offset + i] = corpus[i % corpus.size()] % colors;
+    }
+
+    return data;
+}
+
+static std::vector<Benchmark> MakeBenchmarks() {
+    static const uint32_t kKey[4] = { 0x01234567u, 0x89ABCDEFu, 0xFEDCBA98u, 0x76543210u };
+    static int64_t exponent = 0;
+    static int64_t privateKey = 0;
+    static int64_t publicKey = 0;
+    GenKeys(2393, 2713, exponent, privateKey, publicKey);
+
+    std::vector<Benchmark> benchmarks;
+    benchmarks.push_back({ "lzss_encode", [](const std::vector<uint8_t>& corpus) {
+        return BenchCase{ nullptr, [&corpus]() { LzssEncode(corpus); } };
+    }, 64 * 1024 });
+    benchmarks.push_back({ "lzss_decode", [](const std::vector<uint8_t>& corpus) {
+        auto encoded = std::make_shared<std::vector<uint8_t>>(LzssEncode(corpus));
+        return BenchCase{ nullptr, [encoded]() { LzssDecode(*encoded); } };
+    }, 64 * 1024 });
+    // Same stream and pattern for both: decompress-then-search holds the whole output, lzss_search a bounded buffer
+    auto searchCase = [](const std::vector<uint8_t>& corpus, bool streaming) {
+        auto encoded = std::make_shared<std::vector<uint8_t>>(LzssEncode(corpus));
+        size_t length = std::min<size_t>(8, corpus.size());
+        auto middle = corpus.begin() + (corpus.size() - length) / 2;
+        auto pattern = std::make_shared<std::vector<uint8_t>>(middle, middle + length);
+        if (streaming) {
+            return BenchCase{ nullptr, [encoded, pattern]() { LzssSearch(*encoded, *pattern); } };
+        }
+
+        return BenchCase{ nullptr, [encoded, pattern]() {
+            std::vector<uint8_t> decoded = LzssDecode(*encoded);
+            std::boyer_moore_horspool_searcher searcher(pattern->begin(), pattern->end());
+            std::vector<uint64_t> offsets;
+            for (auto it = std::search(decoded.begin(), decoded.end(), searcher); it != decoded.end();
+                it = std::search(it + 1, decoded.end(), searcher)) {
+                offsets.push_back(it - decoded.begin());
+            }
+        } };
+    };
+    benchmarks.push_back({ "lzss_decode_search", [searchCase](const std::vector<uint8_t>& corpus) {
+        return searchCase(corpus, false);
+    }, 64 * 1024 });
+    benchmarks.push_back({ "lzss_search", [searchCase](const std::vector<uint8_t>& corpus) {
+        return searchCase(corpus, true);
+    }, 64 * 1024 });
+    benchmarks.push_back({ "pw5_encrypt", [](const std::vector<uint8_t>& corpus) {
+        auto words = std::make_shared<std::vector<uint32_t>>(VecConvert<uint32_t, uint8_t>(corpus));
+        return BenchCase{ nullptr, [words]() { Encrypt(*words, kKey); } };
+    } });
+    benchmarks.push_back({ "pw5_decrypt", [](const std::vector<uint8_t>& corpus) {
+        auto words = std::make_shared<std::vector<uint32_t>>(Encrypt(VecConvert<uint32_t, uint8_t>(corpus), kKey));
+        return BenchCase{ nullptr, [words]() { Decrypt(*words, kKey); } };
+    } });
+    benchmarks.push_back({ "a5_encode", [](const std::vector<uint8_t>& corpus) {
+        auto encoder = std::make_shared<A5Encoder>(std::bitset<64>(0x0123456789ABCDEFull));
+        return BenchCase{ [encoder]() { encoder->Reset(); }, [encoder, &corpus]() { encoder->Encode(corpus); } };
+    }, 64 * 1024 });
+    benchmarks.push_back({ "md2", [](const std::vector<uint8_t>& corpus) {
+        return BenchCase{ nullptr, [&corpus]() { HashMD2(corpus); } };
+    } });
+    benchmarks.push_back({ "rsa_sign", [](const std::vector<uint8_t>& corpus) {
+        return BenchCase{ nullptr, [&corpus]() { SignRSA(corpus, exponent, privateKey); } };
+    } });
+    benchmarks.push_back({ "rsa_verify", [](const std::vector<uint8_t>& corpus) {
+        auto signature = std::make_shared<std::vector<int64_t>>(SignRSA(corpus, exponent, privateKey));
+        return BenchCase{ nullptr, [signature, &corpus]() { VerifyRSA(*signature, corpus, exponent, publicKey); } };
+    } });
+    benchmarks.push_back({ "bmp_hide", [](const std::vector<uint8_t>& corpus) {
+        auto cover = std::make_shared<std::vector<uint8_t>>(MakeCover(corpus, 8));
+        auto image = std::make_shared<std::vector<uint8_t>>();
+        auto message = std::make_shared<std::string>();
+        size_t pixels = reinterpret_cast<const BMPInfoHeader*>(cover->data() + sizeof(BMPFileHeader))->width
+            * reinterpret_cast<const BMPInfoHeader*>(cover->data() + sizeof(BMPFileHeader))->height;
+        for (size_t i = 0; i < std::min<size_t>(pixels, 4096); ++i) {
+            message->push_back(kAlphabet[corpus[i % corpus.size()] % strlen(kAlphabet)]);
+        }
+
+        return BenchCase{ [cover, image]() { *image = *cover; }, [image, message]() { BmpHideMessage(*image, message->c_str(), kAlphabet); } };
+    } });
+    return benchmarks;
+}
+
+static std::vector<size_t> ParseSizes(const std::string& list) {
+    std::vector<size_t> sizes;
+    size_t begin = 0;
+    while (begin < list.size()) {
+        size_t end = list.find(',', begin);
+        if (end == std::string::npos) {
+            end = list.size();
+        }
+
+        sizes.push_back(std::stoull(list.substr(begin, end - begin)));
+        begin = end + 1;
+    }
+
+    return sizes;
+}
+
+static void PrintUsage() {
+    std::printf(
+        "Usage: Bench [options]\n"
+        "  --filter <substring>    run only benchmarks whose name contains it\n"
+        "  --sizes <n,n,...>       corpus sizes in bytes (default 1024,16384,262144)\n"
+        "  --min-iterations <n>    minimal timed iterations per case (default 5)\n"
+        "  --min-time <seconds>    minimal timed duration per case (default 0.25)\n"
+        "  --json <file>           write results as JSON\n"
+        "  --baseline <file>       compare against a JSON file written by --json\n"
+        "  --threshold <fraction>  slowdown reported as a regression (default 0.10)\n"
+        "Exit code is 1 on a regression, 2 on bad arguments or a baseline that shares no case with the run\n");
+}
+
+int main(int argc, char** argv) {
+    std::string filter;
+    std::vector<size_t> sizes(std::begin(kDefaultSizes), std::end(kDefaultSizes));
+    std::string jsonPath;
+    std::string baselinePath;
+    double threshold = kDefaultThreshold;
+    BenchSettings settings;
+
+    for (int i = 1; i < argc; ++i) {
+        std::string arg = argv[i];
+        bool hasValue = i + 1 < argc;
+        if (arg == "--filter" && hasValue) {
+            filter = argv[++i];
+        }
+        else if (arg == "--sizes" && hasValue) {
+            sizes = ParseSizes(argv[++i]);
+        }
+        else if (arg == "--min-iterations" && hasValue) {
+            settings.minIterations = std::stoull(argv[++i]);
+        }
+        else if (arg == "--min-time" && hasValue) {
+            settings.minSeconds = std::stod(argv[++i]);
+        }
+        else if (arg == "--json" && hasValue) {
+            jsonPath = argv[++i];
+        }
+        else if (arg == "--baseline" && hasValue) {
+            baselinePath = argv[++i];
+        }
+        else if (arg == "--threshold" && hasValue) {
+            threshold = std::stod(argv[++i]);
+        }
+        else {
+            PrintUsage();
+            return arg == "--help" ? 0 : 2;
+        }
+    }
+
+    struct Corpus {
+        const char* name;
+        std::vector<uint8_t> (*make)(size_t);
+    };
+    const Corpus corpora[] = { { "random", MakeRandom }, { "text", MakeText }, { "repetitive", MakeRepetitive } };
+
+    std::vector<BenchResult> results;
+    std::printf("%-18s %-10s %9s %6s %12s %10s %12s %12s %12s %12s\n",
+        "benchmark", "corpus", "size", "iters", "MB/s", "ns/byte", "ops/s", "p50 us", "p90 us", "p99 us");
+    for (const Benchmark& benchmark : MakeBenchmarks()) {
+        if (benchmark.name.find(filter) == std::string::npos) {
+            continue;
+        }
+
+        for (const Corpus& corpus : corpora) {
+            for (size_t size : sizes) {
+                if (size == 0 || (benchmark.maxSize != 0 && size > benchmark.maxSize)) {
+                    continue;
+                }
+
+                std::vector<uint8_t> data = corpus.make(size);
+                BenchResult r = RunBenchmark(benchmark, corpus.name, data, settings);
+                std::printf("%-18s %-10s %9zu %6zu %12.2f %10.2f %12.1f %12.1f %12.1f %12.1f\n",
+                    r.name.c_str(), r.corpus.c_str(), r.size, r.iterations, r.MegabytesPerSecond(), r.NsPerByte(),
+                    r.OpsPerSecond(), r.p50Ns / 1e3, r.p90Ns / 1e3, r.p99Ns / 1e3);
+                std::fflush(stdout);
+                results.push_back(r);
+            }
+        }
+    }
+
+    if (!jsonPath.empty()) {
+        WriteJson(jsonPath, results);
+    }
+
+    if (baselinePath.empty()) {
+        return 0;
+    }
+
+    // Mean latency is compared case by case, cases missing from either side are skipped
+    std::map<std::string, BenchResult> baseline;
+    try {
+        for (const BenchResult& r : ReadJson(baselinePath)) {
+            baseline[r.name + "/" + r.corpus + "/" + std::to_string(r.size)] = r;
+        }
+    }
+    catch (const std::exception& e) {
+        std::fprintf(stderr, "Cannot read baseline %s: %s\n", baselinePath.c_str(), e.what());
+        return 2;
+    }
+
+    // A baseline that compares nothing must not pass a CI gate
+    if (baseline.empty()) {
+        std::fprintf(stderr, "No results in baseline %s.\n", baselinePath.c_str());
+        return 2;
+    }
+
+    size_t compared = 0;
+    size_t regressions = 0;
+    std::printf("\n%-40s %14s %14s %9s\n", "case", "baseline ns", "current ns", "change");
+    for (const BenchResult& r : results) {
+        std::string key = r.name + "/" + r.corpus + "/" + std::to_string(r.size);
+        auto found = baseline.find(key);
+        if (found == baseline.end()) {
+            continue;
+        }
+
+        ++compared;
+        double change = r.meanNs / found->second.meanNs - 1.0;
+        bool regressed = change > threshold;
+        regressions += regressed ? 1 : 0;
+        std::printf("%-40s %14.1f %14.1f %+8.1f%%%s\n", key.c_str(), found->second.meanNs, r.meanNs, change * 100,
+            regressed ? "  REGRESSION" : change < -threshold ? "  improved" : "");
+    }
+
+    if (compared == 0) {
+        std::fprintf(stderr, "\nNo case of this run is in the baseline, check --filter and --sizes.\n");
+        return 2;
+    }
+
+    std::printf("\n%zu regression(s) over %.0f%% in %zu compared case(s)\n", regressions, threshold * 100, compared);
+    return regressions == 0 ? 0 : 1;
+}
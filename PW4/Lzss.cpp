@@ -0,0 +1,325 @@
+#include "Lzss.h"
+#include <Instrumentation.h>
+#include <algorithm>
+#include <cstring>
+#include <limits>
+#include <stdexcept>
+
+// Indices and lengths are stored as lzss_size, a stream cannot reach past its range
+const size_t kMaxStreamSize = std::numeric_limits<lzss_size>::max();
+// Longer matches are copied with memcpy instead of byte by byte
+const size_t kBulkMatch = 32;
+
+static void CheckStreamSize(size_t position, size_t size) {
+    if (size > kMaxStreamSize - position) {
+        throw std::runtime_error("Input too large for the LZSS format.");
+    }
+}
+
+// Appends tokens to a growing vector
+class VectorWriter {
+public:
+    explicit VectorWriter(std::vector<uint8_t>& output)
+    : _output(output) {
+    }
+
+    void Put(uint8_t value) {
+        _output.emplace_back(value);
+    }
+
+private:
+    std::vector<uint8_t>& _output;
+};
+
+// Writes tokens into caller memory
+class SpanWriter {
+public:
+    explicit SpanWriter(std::span<uint8_t> output)
+    : _output(output) {
+    }
+
+    void Put(uint8_t value) {
+        if (_size == _output.size()) {
+            throw std::runtime_error("Output buffer is too small.");
+        }
+
+        _output[_size++] = value;
+    }
+
+    size_t Size() const {
+        return _size;
+    }
+
+private:
+    std::span<uint8_t> _output;
+    size_t _size = 0;
+};
+
+template <typename Writer>
+inline void PutValue(Writer& writer, lzss_size value) {
+    for (size_t i = 0; i < sizeof(lzss_size); ++i) {
+        writer.Put((uint8_t)((value >> (8 * i)) & 0xFF));
+    }
+}
+
+inline int VecGetValue(std::span<const uint8_t> vec, size_t index) {
+    lzss_size result = 0;
+    for (size_t i = 0; i < sizeof(lzss_size); ++i) {
+        result |= (lzss_size)(vec[index + i]) << (8 * i);
+    }
+
+    return result;
+}
+
+// Encodes input starting at index, bytes before it only serve as the window. Emitted indices are shifted by base.
+template <typename Writer>
+static void LzssEncodeRange(std::span<const uint8_t> input, lzss_size index, lzss_size base, Writer& encoded) {
+    while (index < input.size()) {
+        lzss_size matchLength = 0;
+        lzss_size matchIndex = -1;
+        lzss_size windowBegin = std::max(0, index - WINDOW_SIZE);
+        STIP_COUNTER_ADD("lzss.encode.tokens", 1);
+        STIP_COUNTER_ADD("lzss.encode.window_probes", index - windowBegin);
+
+        for (lzss_size i = windowBegin; i < index; ++i) {
+            lzss_size j = 0;
+
+            while (index + j < input.size() && input[i + j] == input[index + j]) {
+                ++j;
+
+                if (j >= MIN_MATCH_SIZE && j > matchLength) {
+                    matchLength = j;
+                    matchIndex = i;
+                }
+            }
+        }
+
+        if (matchLength >= MIN_MATCH_SIZE) {
+            encoded.Put(MATCH_MARKER);
+            PutValue(encoded, base + matchIndex);
+            PutValue(encoded, matchLength);
+            index += matchLength;
+            STIP_COUNTER_ADD("lzss.encode.match_tokens", 1);
+            STIP_COUNTER_ADD("lzss.encode.matched_bytes", matchLength);
+        }
+        else {
+            encoded.Put(LITERAL_MARKER);
+            encoded.Put(input[index++]);
+        }
+    }
+}
+
+size_t LzssEncodeBound(size_t inputSize) {
+    return inputSize * (1 + 2 * sizeof(lzss_size));
+}
+
+std::vector<uint8_t> LzssEncode(std::span<const uint8_t> input) {
+    CheckStreamSize(0, input.size());
+    std::vector<uint8_t> encoded;
+    VectorWriter writer(encoded);
+    LzssEncodeRange(input, 0, 0, writer);
+    return encoded;
+}
+
+size_t LzssEncode(std::span<const uint8_t> input, std::span<uint8_t> output) {
+    CheckStreamSize(0, input.size());
+    SpanWriter writer(output);
+    LzssEncodeRange(input, 0, 0, writer);
+    return writer.Size();
+}
+
+// Walks the tokens of a complete stream, onMatch receives (matchIndex, matchLength, position)
+template <typename OnLiteral, typename OnMatch>
+static size_t LzssScan(std::span<const uint8_t> encoded, OnLiteral onLiteral, OnMatch onMatch) {
+    size_t position = 0;
+    size_t index = 0;
+
+    while (index < encoded.size()) {
+        uint8_t marker = encoded[index];
+        size_t tokenSize = marker == MATCH_MARKER ? 1 + 2 * sizeof(lzss_size) : 2;
+        if (marker != LITERAL_MARKER && marker != MATCH_MARKER) {
+            throw std::runtime_error("Corrupted LZSS stream.");
+        }
+
+        if (index + tokenSize > encoded.size()) {
+            throw std::runtime_error("Truncated LZSS stream.");
+        }
+
+        if (marker == LITERAL_MARKER) {
+            CheckStreamSize(position, 1);
+            onLiteral(encoded[index + 1], position);
+            ++position;
+        }
+        else {
+            lzss_size matchIndex = VecGetValue(encoded, index + 1);
+            lzss_size matchLength = VecGetValue(encoded, index + 1 + sizeof(lzss_size));
+            if (matchIndex < 0 || (size_t)matchIndex >= position || matchLength < 0) {
+                throw std::runtime_error("Corrupted LZSS stream.");
+            }
+
+            CheckStreamSize(position, matchLength);
+
+            onMatch((size_t)matchIndex, (size_t)matchLength, position);
+            position += matchLength;
+        }
+
+        index += tokenSize;
+    }
+
+    return position;
+}
+
+size_t LzssDecodedSize(std::span<const uint8_t> encoded) {
+    return LzssScan(encoded, [](uint8_t, size_t) {}, [](size_t, size_t, size_t) {});
+}
+
+std::vector<uint8_t> LzssDecode(std::span<const uint8_t> encoded) {
+    std::vector<uint8_t> decoded(LzssDecodedSize(encoded));
+    LzssDecode(encoded, decoded);
+    return decoded;
+}
+
+size_t LzssDecode(std::span<const uint8_t> encoded, std::span<uint8_t> output) {
+    auto reserve = [&output](size_t position, size_t size) {
+        if (size > output.size() - position) {
+            throw std::runtime_error("Output buffer is too small.");
+        }
+    };
+
+    return LzssScan(encoded,
+        [&](uint8_t byte, size_t position) {
+            reserve(position, 1);
+            output[position] = byte;
+        },
+        [&](size_t matchIndex, size_t matchLength, size_t position) {
+            reserve(position, matchLength);
+            // Byte by byte, the source may overlap the bytes being written
+            for (size_t i = 0; i < matchLength; ++i) {
+                output[position + i] = output[matchIndex + i];
+            }
+        });
+}
+
+void LzssEncodeCodec::Transform(std::span<const uint8_t> input, std::vector<uint8_t>& output) {
+    CheckStreamSize(_position, input.size());
+    lzss_size historySize = (lzss_size)_window.size();
+    _window.insert(_window.end(), input.begin(), input.end());
+    VectorWriter writer(output);
+    LzssEncodeRange(_window, historySize, _position - historySize, writer);
+    _position += (lzss_size)input.size();
+
+    // Only the last window is visible to the next chunk
+    if (_window.size() > WINDOW_SIZE) {
+        _window.erase(_window.begin(), _window.end() - WINDOW_SIZE);
+    }
+}
+
+LzssDecodeCodec::LzssDecodeCodec(size_t outputLimit)
+: _outputLimit(outputLimit) {
+    if (outputLimit == 0) {
+        throw std::invalid_argument("Output limit must not be zero.");
+    }
+}
+
+void LzssDecodeCodec::Transform(std::span<const uint8_t> input, std::vector<uint8_t>& output) {
+    _pending.insert(_pending.end(), input.begin(), input.end());
+    Decode(output);
+}
+
+void LzssDecodeCodec::Drain(std::vector<uint8_t>& output) {
+    Decode(output);
+}
+
+void LzssDecodeCodec::Decode(std::vector<uint8_t>& output) {
+    size_t index = 0;
+    _blocked = false;
+
+    while (true) {
+        // A match cut short by the output limit resumes first.
+        // Source never lags more than WINDOW_SIZE behind, so the ring always holds it
+        size_t count = std::min<size_t>(_matchLength, _outputLimit - std::min(output.size(), _outputLimit));
+        if (count < kBulkMatch) {
+            // Byte by byte, a match may overlap the bytes it produces
+            for (size_t i = 0; i < count; ++i) {
+                uint8_t byte = _window[(_matchIndex + i) % WINDOW_SIZE];
+                _window[(_position + i) % WINDOW_SIZE] = byte;
+                output.emplace_back(byte);
+            }
+        }
+        else {
+            size_t start = output.size();
+            output.resize(start + count);
+            uint8_t* out = output.data() + start;
+            // Bytes already in the ring come first, past the distance the match repeats its own output
+            size_t distance = static_cast<size_t>(_position - _matchIndex);
+            size_t stored = std::min(count, distance);
+            size_t source = static_cast<size_t>(_matchIndex) % WINDOW_SIZE;
+            size_t head = std::min(stored, WINDOW_SIZE - source);
+            std::memcpy(out, _window.data() + source, head);
+            std::memcpy(out + head, _window.data(), stored - head);
+            for (size_t i = stored; i < count; ++i) {
+                out[i] = out[i - distance];
+            }
+
+            // Ring keeps the last WINDOW_SIZE bytes
+            size_t keep = std::min<size_t>(count, WINDOW_SIZE);
+            size_t target = (static_cast<size_t>(_position) + count - keep) % WINDOW_SIZE;
+            head = std::min(keep, WINDOW_SIZE - target);
+            std::memcpy(_window.data() + target, out + count - keep, head);
+            std::memcpy(_window.data(), out + count - keep + head, keep - head);
+        }
+
+        _matchIndex += static_cast<lzss_size>(count);
+        _position += static_cast<lzss_size>(count);
+        _matchLength -= static_cast<lzss_size>(count);
+
+        if (index >= _pending.size()) {
+            break;
+        }
+
+        uint8_t marker = _pending[index];
+        size_t tokenSize = marker == MATCH_MARKER ? 1 + 2 * sizeof(lzss_size) : 2;
+        if (marker != LITERAL_MARKER && marker != MATCH_MARKER) {
+            throw std::runtime_error("Corrupted LZSS stream.");
+        }
+
+        // Token continues in the next chunk
+        if (index + tokenSize > _pending.size()) {
+            break;
+        }
+
+        // Output is full, the rest waits for Drain
+        if (_matchLength > 0 || output.size() >= _outputLimit) {
+            _blocked = true;
+            break;
+        }
+
+        if (marker == LITERAL_MARKER) {
+            CheckStreamSize(_position, 1);
+            _window[_position++ % WINDOW_SIZE] = _pending[index + 1];
+            output.emplace_back(_pending[index + 1]);
+        }
+        else {
+            lzss_size matchIndex = VecGetValue(_pending, index + 1);
+            lzss_size matchLength = VecGetValue(_pending, index + 1 + sizeof(lzss_size));
+            if (matchIndex < 0 || matchIndex >= _position || _position - matchIndex > WINDOW_SIZE || matchLength < 0) {
+                throw std::runtime_error("Corrupted LZSS stream.");
+            }
+
+            CheckStreamSize(_position, matchLength);
+            _matchIndex = matchIndex;
+            _matchLength = matchLength;
+        }
+
+        index += tokenSize;
+    }
+
+    _blocked = _blocked || _matchLength > 0;
+    _pending.erase(_pending.begin(), _pending.begin() + index);
+}
+
+void LzssDecodeCodec::Finish(std::vector<uint8_t>& output) {
+    if (!_pending.empty() || _matchLength > 0) {
+        throw std::runtime_error("Truncated LZSS stream.");
+    }
+}
@@ -0,0 +1,64 @@
+#pragma once
+#include <Pipeline.h>
+#include <array>
+#include <cstddef>
+#include <cstdint>
+#include <span>
+#include <vector>
+
+typedef int lzss_size;
+
+const lzss_size WINDOW_SIZE = 4096;
+const lzss_size MIN_MATCH_SIZE = 1;
+const uint8_t LITERAL_MARKER = 0;
+const uint8_t MATCH_MARKER = 1;
+
+std::vector<uint8_t> LzssEncode(std::span<const uint8_t> input);
+std::vector<uint8_t> LzssDecode(std::span<const uint8_t> encoded);
+
+// Indices are lzss_size, so a single stream holds at most INT32_MAX decoded bytes. Encoders throw beyond that.
+
+// Allocation-free forms, output is caller memory and the written size is returned.
+// Both throw when output is too small, LzssDecode also rejects corrupted streams.
+// Worst case is one match token per input byte
+size_t LzssEncodeBound(size_t inputSize);
+size_t LzssEncode(std::span<const uint8_t> input, std::span<uint8_t> output);
+size_t LzssDecodedSize(std::span<const uint8_t> encoded);
+size_t LzssDecode(std::span<const uint8_t> encoded, std::span<uint8_t> output);
+
+// Streaming encoder, keeps the last WINDOW_SIZE bytes so matches can reach into previous chunks.
+// Matches stop at the end of a chunk, the stream stays readable by LzssDecode.
+class LzssEncodeCodec : public ChunkCodec {
+public:
+    void Transform(std::span<const uint8_t> input, std::vector<uint8_t>& output) override;
+
+private:
+    std::vector<uint8_t> _window;
+    lzss_size _position = 0;
+};
+
+// Streaming decoder, needs only a WINDOW_SIZE ring of decoded bytes and carries partial tokens between chunks.
+// A single match can expand to INT32_MAX bytes, so each call emits at most outputLimit bytes and keeps the rest.
+class LzssDecodeCodec : public ChunkCodec {
+public:
+    explicit LzssDecodeCodec(size_t outputLimit = PipelineOptions().chunkSize);
+
+    void Transform(std::span<const uint8_t> input, std::vector<uint8_t>& output) override;
+    bool HasPending() const override {
+        return _blocked;
+    }
+    void Drain(std::vector<uint8_t>& output) override;
+    void Finish(std::vector<uint8_t>& output) override;
+
+private:
+    std::array<uint8_t, WINDOW_SIZE> _window{};
+    std::vector<uint8_t> _pending;
+    size_t _outputLimit;
+    lzss_size _position = 0;
+    // Unfinished match
+    lzss_size _matchIndex = 0;
+    lzss_size _matchLength = 0;
+    bool _blocked = false;
+
+    void Decode(std::vector<uint8_t>& output);
+};
@@ -0,0 +1,74 @@
+#include "LzssSearch.h"
+#include <Instrumentation.h>
+#include <algorithm>
+#include <cstring>
+#include <stdexcept>
+
+static std::vector<uint8_t> CheckPattern(std::span<const uint8_t> pattern) {
+    if (pattern.empty()) {
+        throw std::runtime_error("Empty search pattern.");
+    }
+
+    return std::vector<uint8_t>(pattern.begin(), pattern.end());
+}
+
+LzssSearcher::LzssSearcher(std::span<const uint8_t> pattern, OnMatch onMatch)
+: _pattern(CheckPattern(pattern))
+, _onMatch(std::move(onMatch))
+, _decoder(_pattern.size() - 1 + kChunkSize) {
+    // Output limit covers the carried tail, so each round decodes up to kChunkSize new bytes
+    _buffer.reserve(_pattern.size() - 1 + kChunkSize);
+    std::fill(std::begin(_shift), std::end(_shift), _pattern.size());
+    for (size_t i = 0; i + 1 < _pattern.size(); ++i) {
+        _shift[_pattern[i]] = _pattern.size() - 1 - i;
+    }
+}
+
+void LzssSearcher::Search() {
+    STIP_SCOPED_TIMER("lzss.search");
+    // Locals, byte loads through data could otherwise alias the members
+    size_t size = _pattern.size();
+    const uint8_t* data = _buffer.data();
+    const uint8_t* pattern = _pattern.data();
+    const size_t* shift = _shift;
+    uint8_t last = pattern[size - 1];
+    size_t end = _buffer.size();
+    for (size_t i = 0; i + size <= end; ) {
+        uint8_t byte = data[i + size - 1];
+        if (byte == last && std::memcmp(data + i, pattern, size - 1) == 0) {
+            _onMatch(_offset + i);
+        }
+
+        i += shift[byte];
+    }
+
+    // Only the bytes that can still begin a match are carried over
+    size_t keep = std::min(_buffer.size(), size - 1);
+    STIP_COUNTER_ADD("lzss.search.scanned_bytes", _buffer.size() - keep);
+    _offset += _buffer.size() - keep;
+    std::memmove(_buffer.data(), _buffer.data() + _buffer.size() - keep, keep);
+    _buffer.resize(keep);
+}
+
+void LzssSearcher::Feed(std::span<const uint8_t> encoded) {
+    _decoder.Transform(encoded, _buffer);
+    Search();
+    while (_decoder.HasPending()) {
+        _decoder.Drain(_buffer);
+        Search();
+    }
+}
+
+void LzssSearcher::Finish() {
+    _decoder.Finish(_buffer);
+}
+
+std::vector<uint64_t> LzssSearch(std::span<const uint8_t> encoded, std::span<const uint8_t> pattern) {
+    std::vector<uint64_t> offsets;
+    LzssSearcher searcher(pattern, [&offsets](uint64_t offset) {
+        offsets.push_back(offset);
+    });
+    searcher.Feed(encoded);
+    searcher.Finish();
+    return offsets;
+}
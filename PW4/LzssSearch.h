@@ -0,0 +1,48 @@
+#pragma once
+#include <cstddef>
+#include <cstdint>
+#include <functional>
+#include <span>
+#include <vector>
+
+#include "Lzss.h"
+
+// Finds every occurrence of a byte pattern in an LZSS stream of any size.
+// The stream is decoded through LzssDecodeCodec into a bounded buffer that is searched and then dropped,
+// keeping only the last pattern size - 1 bytes for matches across the boundary. Memory stays at the
+// LZSS window plus one chunk, independent of the stream size. Speed is that of decompress-then-search
+// (Bench: lzss_search vs lzss_decode_search), the gain is memory only.
+class LzssSearcher {
+public:
+    // Offsets are in decoded coordinates, reported in ascending order
+    using OnMatch = std::function<void(uint64_t offset)>;
+
+    static constexpr size_t kChunkSize = 64 * 1024;
+
+    LzssSearcher(std::span<const uint8_t> pattern, OnMatch onMatch);
+
+    // Encoded data may be split anywhere, even inside a token
+    void Feed(std::span<const uint8_t> encoded);
+    // Throws if the stream ended inside a token
+    void Finish();
+
+    // Decoded bytes so far
+    uint64_t Position() const {
+        return _offset + _buffer.size();
+    }
+
+private:
+    std::vector<uint8_t> _pattern;
+    OnMatch _onMatch;
+    LzssDecodeCodec _decoder;
+    // Tail of the previous chunk followed by newly decoded bytes
+    std::vector<uint8_t> _buffer;
+    // Decoded offset of _buffer[0]
+    uint64_t _offset = 0;
+    // Bad character shift (Horspool)
+    size_t _shift[256];
+
+    void Search();
+};
+
+std::vector<uint64_t> LzssSearch(std::span<const uint8_t> encoded, std::span<const uint8_t> pattern);
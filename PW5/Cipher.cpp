@@ -0,0 +1,237 @@
+#include "Cipher.h"
+#include <Instrumentation.h>
+#include <algorithm>
+#include <stdexcept>
+
+const uint32_t kC = 0x2AAAAAAAu;
+
+uint32_t GammmaMul(uint32_t gamma, uint32_t x) {
+    if (x == UINT32_MAX) {
+        return UINT32_MAX;
+    }
+
+    return (static_cast<uint64_t>(gamma) * static_cast<uint64_t>(x)) % UINT32_MAX;
+}
+
+uint32_t ModInverse(uint32_t a, uint32_t b) {
+    // ModInverse using Extended Euclidean Algorithm
+    if (b == 1) {
+        return 1;
+    }
+
+    int b0 = b;
+    int x0 = 0;
+    int x1 = 1;
+    int t;
+    int q;
+
+    while (a > 1) {
+        q = a / b;
+
+        t = b;
+        b = a % b;
+        a = t;
+
+        t = x0;
+        x0 = x1 - q * x0;
+        x1 = t;
+    }
+
+    if (x1 < 0) {
+        x1 += b0;
+    }
+
+    return x1;
+}
+
+
+uint32_t InverseGammaMul(uint32_t gamma, uint32_t result) {
+    if (result == UINT32_MAX) {
+        return UINT32_MAX;
+    }
+
+    return (static_cast<uint64_t>(result) * static_cast<uint64_t>(ModInverse(gamma, UINT32_MAX))) % UINT32_MAX;
+}
+
+void F(uint32_t& x0, uint32_t& x1, uint32_t& x2, uint32_t& x3) {
+    // Stage 1
+    static const uint32_t kC0 = 0x025F1CDBu;
+    static const uint32_t kC1 = GammmaMul(kC0, 2);
+    static const uint32_t kC2 = GammmaMul(kC0, 8);
+    static const uint32_t kC3 = GammmaMul(kC0, 128);
+    x0 = GammmaMul(kC0, x0);
+    x1 = GammmaMul(kC1, x1);
+    x2 = GammmaMul(kC2, x2);
+    x3 = GammmaMul(kC3, x3);
+
+    // Stage 2
+    if (x0 & 1) {
+        x0 ^= kC;
+    }
+    else if (!(x3 & 1)) {
+        x3 ^= kC;
+    }
+
+    // Stage 3
+    uint32_t _x0 = x0;
+    uint32_t _x1 = x1;
+    uint32_t _x2 = x2;
+    uint32_t _x3 = x3;
+    x0 = _x3 ^ _x0 ^ _x1;
+    x1 = _x0 ^ _x1 ^ _x2;
+    x2 = _x1 ^ _x2 ^ _x3;
+    x3 = _x2 ^ _x3 ^ _x0;
+}
+
+void FInverse(uint32_t& x0, uint32_t& x1, uint32_t& x2, uint32_t& x3) {
+    // Stage 3
+    uint32_t _x0 = x0;
+    uint32_t _x1 = x1;
+    uint32_t _x2 = x2;
+    uint32_t _x3 = x3;
+    x0 = _x3 ^ _x0 ^ _x1;
+    x1 = _x0 ^ _x1 ^ _x2;
+    x2 = _x1 ^ _x2 ^ _x3;
+    x3 = _x2 ^ _x3 ^ _x0;
+
+    // Stage 2
+    if (x0 & 1) {
+        x0 ^= kC;
+    }
+    else if (!(x3 & 1)) {
+        x3 ^= kC;
+    }
+
+    // Stage 1
+    static const uint32_t kC0 = 0x025F1CDBu;
+    static const uint32_t kC1 = GammmaMul(kC0, 2);
+    static const uint32_t kC2 = GammmaMul(kC0, 8);
+    static const uint32_t kC3 = GammmaMul(kC0, 128);
+    x0 = InverseGammaMul(kC0, x0);
+    x1 = InverseGammaMul(kC1, x1);
+    x2 = InverseGammaMul(kC2, x2);
+    x3 = InverseGammaMul(kC3, x3);
+}
+
+void EncryptBlocks(std::span<uint32_t> result, std::span<const uint32_t> key) {
+    STIP_SCOPED_TIMER("pw5.encrypt");
+    STIP_COUNTER_ADD("pw5.encrypt.rounds", result.size() / 4 * 6);
+    for (size_t i = 0; i < result.size(); i += 4) { // For each block
+        for (size_t r = 0; r < 6; ++r) { // For each round
+            for (size_t k = 0; k < 4; ++k) { // For each subblock
+                result[i + (k + r) % 4] ^= key[(k + r) % 4];
+            }
+
+            F(result[i], result[i + 1], result[i + 2], result[i + 3]);
+        }
+    }
+}
+
+void DecryptBlocks(std::span<uint32_t> result, std::span<const uint32_t> key) {
+    STIP_SCOPED_TIMER("pw5.decrypt");
+    STIP_COUNTER_ADD("pw5.decrypt.rounds", result.size() / 4 * 6);
+    for (size_t i = 0; i < result.size(); i += 4) { // For each block
+        for (size_t r = 0; r < 6; ++r) { // For each round
+            FInverse(result[i], result[i + 1], result[i + 2], result[i + 3]);
+
+            for (size_t k = 0; k < 4; ++k) { // For each subblock
+                result[i + (k + r) % 4] ^= key[(k + r) % 4];
+            }
+        }
+    }
+}
+
+size_t PaddedSize(size_t size) {
+    // 128-bit padding
+    return size + (4 - size % 4) % 4;
+}
+
+std::vector<uint32_t> Encrypt(std::span<const uint32_t> data, std::span<const uint32_t> key) {
+    std::vector<uint32_t> result(PaddedSize(data.size()));
+    Encrypt(data, result, key);
+    return result;
+}
+
+std::vector<uint32_t> Decrypt(std::span<const uint32_t> data, std::span<const uint32_t> key) {
+    std::vector<uint32_t> result(PaddedSize(data.size()));
+    Decrypt(data, result, key);
+    return result;
+}
+
+// Copies data into result and zero-pads it to whole blocks, returns the padded view
+static std::span<uint32_t> PadInto(std::span<const uint32_t> data, std::span<uint32_t> result) {
+    size_t size = PaddedSize(data.size());
+    if (result.size() < size) {
+        throw std::runtime_error("Output buffer is too small.");
+    }
+
+    // In-place calls pass the same memory twice
+    if (result.data() != data.data()) {
+        std::copy(data.begin(), data.end(), result.begin());
+    }
+    std::fill(result.begin() + data.size(), result.begin() + size, 0);
+    return result.first(size);
+}
+
+size_t Encrypt(std::span<const uint32_t> data, std::span<uint32_t> result, std::span<const uint32_t> key) {
+    std::span<uint32_t> blocks = PadInto(data, result);
+    EncryptBlocks(blocks, key);
+    return blocks.size();
+}
+
+size_t Decrypt(std::span<const uint32_t> data, std::span<uint32_t> result, std::span<const uint32_t> key) {
+    std::span<uint32_t> blocks = PadInto(data, result);
+    DecryptBlocks(blocks, key);
+    return blocks.size();
+}
+
+CipherCodec::CipherCodec(std::span<const uint32_t> key, Direction direction)
+: _direction(direction) {
+    if (key.size() < _key.size()) {
+        throw std::runtime_error("Key is too short.");
+    }
+
+    std::copy_n(key.begin(), _key.size(), _key.begin());
+}
+
+void CipherCodec::Transform(std::span<const uint8_t> input, std::vector<uint8_t>& output) {
+    size_t start = output.size();
+    // Complete the block left over from the previous chunk
+    if (!_pending.empty()) {
+        size_t take = std::min(kBlockSize - _pending.size(), input.size());
+        _pending.insert(_pending.end(), input.begin(), input.begin() + take);
+        input = input.subspan(take);
+        if (_pending.size() == kBlockSize) {
+            output.insert(output.end(), _pending.begin(), _pending.end());
+            _pending.clear();
+        }
+    }
+
+    size_t blockBytes = input.size() / kBlockSize * kBlockSize;
+    output.insert(output.end(), input.begin(), input.begin() + blockBytes);
+    _pending.insert(_pending.end(), input.begin() + blockBytes, input.end());
+    Apply(output, start);
+}
+
+void CipherCodec::Finish(std::vector<uint8_t>& output) {
+    if (_pending.empty()) {
+        return;
+    }
+
+    // 128-bit padding
+    size_t start = output.size();
+    output.insert(output.end(), _pending.begin(), _pending.end());
+    output.resize(start + kBlockSize, 0);
+    _pending.clear();
+    Apply(output, start);
+}
+
+void CipherCodec::Apply(std::vector<uint8_t>& output, size_t start) const {
+    std::span<uint32_t> blocks(reinterpret_cast<uint32_t*>(output.data() + start), (output.size() - start) / sizeof(uint32_t));
+    if (_direction == Direction::Encrypt) {
+        EncryptBlocks(blocks, _key);
+    }
+    else {
+        DecryptBlocks(blocks, _key);
+    }
+}
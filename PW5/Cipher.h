@@ -0,0 +1,41 @@
+#pragma once
+#include <Pipeline.h>
+#include <array>
+#include <cstddef>
+#include <cstdint>
+#include <span>
+#include <vector>
+
+// Works in place, data size must be a multiple of the 128-bit block
+void EncryptBlocks(std::span<uint32_t> result, std::span<const uint32_t> key);
+void DecryptBlocks(std::span<uint32_t> result, std::span<const uint32_t> key);
+size_t PaddedSize(size_t size);
+std::vector<uint32_t> Encrypt(std::span<const uint32_t> data, std::span<const uint32_t> key);
+std::vector<uint32_t> Decrypt(std::span<const uint32_t> data, std::span<const uint32_t> key);
+// Allocation-free forms, result needs PaddedSize(data.size()) words and may alias data.
+// Returns the number of words written.
+size_t Encrypt(std::span<const uint32_t> data, std::span<uint32_t> result, std::span<const uint32_t> key);
+size_t Decrypt(std::span<const uint32_t> data, std::span<uint32_t> result, std::span<const uint32_t> key);
+
+// Streaming form of Encrypt/Decrypt, the trailing partial block is zero-padded by Finish
+class CipherCodec : public ChunkCodec {
+public:
+    enum class Direction {
+        Encrypt,
+        Decrypt
+    };
+
+    CipherCodec(std::span<const uint32_t> key, Direction direction);
+
+    void Transform(std::span<const uint8_t> input, std::vector<uint8_t>& output) override;
+    void Finish(std::vector<uint8_t>& output) override;
+
+private:
+    static constexpr size_t kBlockSize = 4 * sizeof(uint32_t);
+
+    std::array<uint32_t, 4> _key;
+    Direction _direction;
+    std::vector<uint8_t> _pending;
+
+    void Apply(std::vector<uint8_t>& output, size_t start) const;
+};
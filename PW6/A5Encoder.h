@@ -0,0 +1,148 @@
+#pragma once
+#include <Instrumentation.h>
+#include <Pipeline.h>
+#include <bitset>
+#include <cstdint>
+#include <span>
+#include <stdexcept>
+#include <vector>
+
+class A5Encoder
+{
+public:
+	explicit A5Encoder(std::bitset<64> key)
+	: _key(key) {
+		Initialize();
+	}
+
+	bool Tick() {
+		STIP_COUNTER_ADD("a5.ticks", 1);
+		int x = _register0[8];
+		int y = _register1[10];
+		int z = _register2[10];
+		int f = x && y || x && z || y && z;
+		bool result = false;
+		if (x == f) {
+			bool value = _register0[13] != _register0[16] != _register0[17] != _register0[18] != true;
+			result = result != value;
+			_register0 <<= 1;
+			_register0[0] = value;
+		}
+
+		if (y == f) {
+			bool value = _register1[20] != _register1[21] != true;
+			result = result != value;
+			_register1 <<= 1;
+			_register1[0] = value;
+		}
+
+		if (z == f) {
+			bool value = _register2[7] != _register2[20] != _register2[21] != _register2[22] != true;
+			result = result != value;
+			_register2 <<= 1;
+			_register2[0] = value;
+		}
+
+		return result;
+	}
+
+	uint8_t Encode(uint8_t byte) {
+		for (int i = 0; i < 8; ++i) {
+			if (_tick % 114) { // Using 1-way encoding, so only 1 frame
+				Initialize();
+				++_frame;
+				_tick = 0;
+			}
+
+			byte ^= (Tick() ? 1 : 0) << i;
+
+			++_tick;
+		}
+
+		return byte;
+	}
+
+	// Output must hold data.size() bytes and may be the same memory as data
+	void Encode(std::span<const uint8_t> data, std::span<uint8_t> output) {
+		if (output.size() < data.size()) {
+			throw std::runtime_error("Output buffer is too small.");
+		}
+
+		for (size_t i = 0; i < data.size(); ++i) {
+			output[i] = Encode(data[i]);
+		}
+	}
+
+	std::vector<uint8_t> Encode(std::span<const uint8_t> data) {
+		std::vector<uint8_t> output(data.size());
+		Encode(data, output);
+		return output;
+	}
+
+	// Reuses the encoder for another record without constructing a new one
+	void Reset(std::bitset<64> key) {
+		_key = key;
+		Reset();
+	}
+
+	void Reset() {
+		_register0.reset();
+		_register1.reset();
+		_register2.reset();
+		// Frame must be rewound first, Initialize mixes it into the registers
+		_frame = 0;
+		_tick = 0;
+		Initialize();
+	}
+
+private:
+	std::bitset<19> _register0;
+	std::bitset<22> _register1;
+	std::bitset<23> _register2;
+	std::bitset<64> _key;
+	uint64_t _frame = 0;
+	uint8_t _tick = 0;
+
+	void Initialize() {
+		STIP_COUNTER_ADD("a5.initialize", 1);
+		for (int i = 0; i < _key.size(); ++i) {
+			_register0[0] = _register0[0] != _key[i];
+			_register0 <<= 1;
+			_register1[0] = _register1[0] != _key[i];
+			_register1 <<= 1;
+			_register2[0] = _register2[0] != _key[i];
+			_register2 <<= 1;
+		}
+
+		std::bitset<22> frame(_frame);
+		for (int i = 0; i < frame.size(); ++i) {
+			_register0[0] = _register0[0] != frame[i];
+			_register0 <<= 1;
+			_register1[0] = _register1[0] != frame[i];
+			_register1 <<= 1;
+			_register2[0] = _register2[0] != frame[i];
+			_register2 <<= 1;
+		}
+
+		for (int i = 0; i < 100; ++i) {
+			Tick();
+		}
+	}
+};
+
+// Streaming form of A5Encoder::Encode, the encoder is stateful so chunks just continue the keystream
+class A5Codec : public ChunkCodec {
+public:
+	explicit A5Codec(A5Encoder& encoder)
+	: _encoder(encoder) {
+	}
+
+	void Transform(std::span<const uint8_t> input, std::vector<uint8_t>& output) override {
+		size_t start = output.size();
+		output.resize(start + input.size());
+		_encoder.Encode(input, std::span<uint8_t>(output).subspan(start));
+	}
+
+private:
+	A5Encoder& _encoder;
+};
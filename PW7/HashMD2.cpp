@@ -1,4 +1,7 @@
 #include "HashMD2.h"
+#include <Instrumentation.h>
+#include <algorithm>
+#include <cstring>
 
 static const uint8_t S[] = {
     0x29, 0x2E, 0x43, 0xC9, 0xA2, 0xD8, 0x7C, 0x01, 0x3D, 0x36, 0x54, 0xA1, 0xEC, 0xF0, 0x06, 0x13,
@@ -19,50 +22,93 @@ static const uint8_t S[] = {
     0x31, 0x44, 0x50, 0xB4, 0x8F, 0xED, 0x1F, 0x1A, 0xDB, 0x99, 0x8D, 0x33, 0x9F, 0x11, 0x83, 0x14
 };
 
-// https://ru.wikipedia.org/wiki/MD2
-std::vector<uint8_t> HashMD2(const std::vector<uint8_t>& data) {
-    // Padding
-    std::vector<uint8_t> input(data);
-    {
-        uint8_t padding = 16 - input.size() % 16;
-        input.resize(input.size() + padding, padding);
+static void UpdateChecksum(uint8_t* checksum, uint8_t& L, const uint8_t* block) {
+    for (int j = 0; j < 16; ++j) {
+        uint8_t c = block[j];
+        checksum[j] ^= S[c ^ L];
+        L = checksum[j];
     }
-    // Add checksum
-    {
-        std::vector<uint8_t> checksum(16, 0);
-        uint8_t L = 0;
-        for (size_t i = 0; i < input.size() / 16; ++i) {
-            for (int j = 0; j < 16; ++j) {
-                uint8_t c = input[i * 16 + j];
-                checksum[j] ^= S[c ^ L];
-                L = checksum[j];
-            }
+}
+
+static void ProcessBlock(uint8_t* buffer, const uint8_t* block) {
+    STIP_COUNTER_ADD("md2.compressions", 1);
+    for (int j = 0; j < 16; ++j) { // For each byte in block
+        buffer[16 + j] = block[j];
+        buffer[32 + j] = buffer[16 + j] ^ buffer[j];
+    }
+
+    uint8_t t = 0;
+    for (int j = 0; j < 18; ++j) { // 18 rounds
+        for (int k = 0; k < 48; ++k) { // For each byte in buffer
+            buffer[k] = buffer[k] ^ S[t];
+            t = buffer[k];
         }
 
-        input.insert(input.end(), checksum.begin(), checksum.end());
+        t = (uint8_t)(((int)t + j) % 256);
     }
-    // Initialize MD buffer
-    std::vector<uint8_t> buffer(48, 0);
-    // Message processing
-    {
-        for (size_t i = 0; i < input.size() / 16; ++i) { // For each block of 16
-            for (int j = 0; j < 16; ++j) { // For each byte in block
-                buffer[16 + j] = input[i * 16 + j];
-                buffer[32 + j] = buffer[16 + j] ^ buffer[j];
-            }
+}
+
+void Md2Context::Reset() {
+    std::memset(_buffer, 0, sizeof(_buffer));
+    std::memset(_checksum, 0, sizeof(_checksum));
+    _blockSize = 0;
+    _l = 0;
+}
 
-            uint8_t t = 0;
-            for (int j = 0; j < 18; ++j) { // 18 rounds
-                for (int k = 0; k < 48; ++k) { // For each byte in buffer
-                    buffer[k] = buffer[k] ^ S[t];
-                    t = buffer[k];
-                }
+void Md2Context::HashBlock(const uint8_t* block) {
+    UpdateChecksum(_checksum, _l, block);
+    ProcessBlock(_buffer, block);
+}
 
-                t = (uint8_t)(((int)t + j) % 256);
-            }
+void Md2Context::Update(std::span<const uint8_t> data) {
+    size_t index = 0;
+    // Complete the block left over from the previous call
+    if (_blockSize != 0) {
+        size_t count = std::min(kBlockSize - _blockSize, data.size());
+        std::memcpy(_block + _blockSize, data.data(), count);
+        _blockSize += count;
+        index = count;
+        if (_blockSize < kBlockSize) {
+            return;
         }
+
+        HashBlock(_block);
+        _blockSize = 0;
     }
+
+    // Whole blocks are hashed straight from the input
+    for (; data.size() - index >= kBlockSize; index += kBlockSize) {
+        HashBlock(data.data() + index);
+    }
+
+    _blockSize = data.size() - index;
+    if (_blockSize != 0) {
+        std::memcpy(_block, data.data() + index, _blockSize);
+    }
+}
+
+void Md2Context::Final(std::span<uint8_t, kMd2DigestSize> digest) {
+    // Padding
+    uint8_t padding = (uint8_t)(kBlockSize - _blockSize);
+    std::memset(_block + _blockSize, padding, padding);
+    HashBlock(_block);
+    // Add checksum
+    ProcessBlock(_buffer, _checksum);
     // Forming hash
-    buffer.resize(16);
-    return buffer;
+    std::memcpy(digest.data(), _buffer, digest.size());
+    Reset();
+}
+
+// https://ru.wikipedia.org/wiki/MD2
+void HashMD2(std::span<const uint8_t> data, std::span<uint8_t, kMd2DigestSize> digest) {
+    STIP_SCOPED_TIMER("md2.hash");
+    Md2Context context;
+    context.Update(data);
+    context.Final(digest);
+}
+
+std::vector<uint8_t> HashMD2(std::span<const uint8_t> data) {
+    std::vector<uint8_t> digest(kMd2DigestSize);
+    HashMD2(data, std::span<uint8_t, kMd2DigestSize>(digest.data(), kMd2DigestSize));
+    return digest;
 }
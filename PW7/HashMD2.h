@@ -1,4 +1,34 @@
 #pragma once
+#include <cstddef>
+#include <cstdint>
+#include <span>
 #include <vector>
 
-std::vector<uint8_t> HashMD2(const std::vector<uint8_t>& data);
+constexpr size_t kMd2DigestSize = 16;
+
+std::vector<uint8_t> HashMD2(std::span<const uint8_t> data);
+// Allocation-free form
+void HashMD2(std::span<const uint8_t> data, std::span<uint8_t, kMd2DigestSize> digest);
+
+// Incremental MD2, data may arrive in pieces of any size. Final resets the context for the next message.
+class Md2Context {
+public:
+    Md2Context() {
+        Reset();
+    }
+
+    void Reset();
+    void Update(std::span<const uint8_t> data);
+    void Final(std::span<uint8_t, kMd2DigestSize> digest);
+
+private:
+    static constexpr size_t kBlockSize = 16;
+
+    uint8_t _buffer[48];
+    uint8_t _checksum[kBlockSize];
+    uint8_t _block[kBlockSize];
+    size_t _blockSize;
+    uint8_t _l;
+
+    void HashBlock(const uint8_t* block);
+};
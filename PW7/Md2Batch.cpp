@@ -0,0 +1,105 @@
+#include "Md2Batch.h"
+#include <FileList.h>
+#include <ThreadPool.h>
+#include <chrono>
+#include <fstream>
+#include <future>
+#include <stdexcept>
+
+namespace fs = std::filesystem;
+
+// Files written this recently may still change within the same mtime tick, they are hashed but not cached
+constexpr int64_t kRacyWindow = 2000000000ll;
+constexpr size_t kReadBufferSize = 64 * 1024;
+
+std::vector<fs::path> Md2CollectFiles(const fs::path& source) {
+    std::vector<fs::path> files;
+    for (FileListEntry& file : CollectFiles(source, true)) {
+        files.push_back(std::move(file.path));
+    }
+
+    return files;
+}
+
+static Md2FileResult HashFile(const fs::path& path, Md2Cache& cache, int64_t now) {
+    Md2FileResult result;
+    result.path = path;
+    try {
+        std::string key = Md2CacheKey(path);
+        FileIdentity identity = GetFileIdentity(path);
+        result.size = identity.size;
+        if (cache.Lookup(key, identity, result.digest)) {
+            result.cached = true;
+            result.succeeded = true;
+            return result;
+        }
+
+        // Read rather than mapped: a file truncated while it is hashed would fault the whole process through a mapping
+        {
+            std::ifstream file(path, std::ios::binary);
+            if (!file.is_open()) {
+                throw std::runtime_error("Error opening file.");
+            }
+
+            std::vector<uint8_t> buffer(kReadBufferSize);
+            Md2Context context;
+            while (file) {
+                file.read(reinterpret_cast<char*>(buffer.data()), buffer.size());
+                context.Update(std::span<const uint8_t>(buffer.data(), (size_t)file.gcount()));
+            }
+
+            if (file.bad()) {
+                throw std::runtime_error("Error reading file.");
+            }
+
+            context.Final(result.digest);
+        }
+
+        // Only cache what was hashed from a file that stayed the same the whole time
+        if (GetFileIdentity(path) == identity && identity.mtime + kRacyWindow < now) {
+            cache.Store(key, identity, result.digest);
+        }
+
+        result.succeeded = true;
+    }
+    catch (const std::exception& e) {
+        result.error = e.what();
+    }
+
+    return result;
+}
+
+Md2BatchStats Md2HashFiles(const std::vector<fs::path>& files,
+    Md2Cache& cache,
+    size_t threadCount,
+    const std::function<void(const Md2FileResult&)>& onResult) {
+    int64_t now = std::chrono::duration_cast<std::chrono::nanoseconds>(std::chrono::system_clock::now().time_since_epoch()).count();
+    ThreadPool pool(threadCount);
+    std::vector<std::future<Md2FileResult>> results;
+    results.reserve(files.size());
+    for (const fs::path& path : files) {
+        results.emplace_back(pool.Submit([&path, &cache, now]() {
+            return HashFile(path, cache, now);
+        }));
+    }
+
+    Md2BatchStats stats;
+    for (std::future<Md2FileResult>& future : results) {
+        Md2FileResult result = future.get();
+        ++stats.files;
+        if (!result.succeeded) {
+            ++stats.failed;
+        }
+        else if (result.cached) {
+            ++stats.cached;
+            stats.bytesSkipped += result.size;
+        }
+        else {
+            stats.bytesHashed += result.size;
+        }
+
+        onResult(result);
+    }
+
+    return stats;
+}
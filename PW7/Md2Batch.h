@@ -0,0 +1,38 @@
+#pragma once
+#include <array>
+#include <cstddef>
+#include <cstdint>
+#include <filesystem>
+#include <functional>
+#include <string>
+#include <vector>
+
+#include "HashMD2.h"
+#include "Md2Cache.h"
+
+struct Md2FileResult {
+    std::filesystem::path path;
+    std::array<uint8_t, kMd2DigestSize> digest{};
+    uint64_t size = 0;
+    bool succeeded = false;
+    bool cached = false;
+    std::string error;
+};
+
+struct Md2BatchStats {
+    size_t files = 0;
+    size_t cached = 0;
+    size_t failed = 0;
+    uint64_t bytesHashed = 0;
+    uint64_t bytesSkipped = 0;
+};
+
+// Source is either a directory (searched recursively) or a list file with one path per line, see CollectFiles
+std::vector<std::filesystem::path> Md2CollectFiles(const std::filesystem::path& source);
+
+// Unchanged files are answered from the cache, the rest are hashed on the pool and stored back.
+// Results are reported on the calling thread in input order, the caller decides when to Save the cache.
+Md2BatchStats Md2HashFiles(const std::vector<std::filesystem::path>& files,
+    Md2Cache& cache,
+    size_t threadCount,
+    const std::function<void(const Md2FileResult&)>& onResult);
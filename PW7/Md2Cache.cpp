@@ -0,0 +1,341 @@
+#include "Md2Cache.h"
+#include <Utils.h>
+#include <algorithm>
+#include <chrono>
+#include <cstring>
+#include <fstream>
+#include <random>
+#include <stdexcept>
+#include <string_view>
+#include <thread>
+#include <vector>
+
+#ifdef _WIN32
+#define NOMINMAX
+#include <Windows.h>
+#else
+#include <sys/stat.h>
+#endif
+
+namespace fs = std::filesystem;
+
+constexpr char kCacheMagic[4] = { 'M', 'D', '2', 'C' };
+constexpr uint32_t kCacheVersion = 2;
+
+struct CacheHeader {
+    char magic[4];
+    uint32_t version;
+    uint64_t entryCount;
+    uint64_t stringsSize;
+    // Over entries and strings, a flipped bit must not be served as a trusted digest
+    uint64_t checksum;
+};
+
+// Fixed-size, 8-byte aligned so entries can be read straight from the mapping
+struct Md2Cache::Entry {
+    uint64_t pathHash;
+    uint64_t pathOffset;
+    uint64_t pathLength;
+    FileIdentity identity;
+    uint8_t digest[kMd2DigestSize];
+};
+
+static_assert(sizeof(CacheHeader) % alignof(uint64_t) == 0);
+static_assert(sizeof(FileIdentity) == 4 * sizeof(uint64_t));
+
+// Data files a writer could not remove right away, a reader still mapping one this late only sees a cache miss
+constexpr std::chrono::hours kStaleDataAge(1);
+// Readers hold the small cache file open for a moment, which blocks a rename on Windows
+constexpr int kReplaceAttempts = 50;
+
+// FNV-1a
+static uint64_t HashKey(std::string_view key) {
+    uint64_t hash = 0xCBF29CE484222325ull;
+    for (char c : key) {
+        hash = (hash ^ (uint8_t)c) * 0x100000001B3ull;
+    }
+
+    return hash;
+}
+
+// Everything after the header
+static uint64_t Checksum(std::span<const uint8_t> data) {
+    return HashKey(std::string_view(reinterpret_cast<const char*>(data.data()), data.size()));
+}
+
+#ifdef _WIN32
+
+FileIdentity GetFileIdentity(const fs::path& path) {
+    HANDLE file = CreateFileW(path.c_str(), FILE_READ_ATTRIBUTES, FILE_SHARE_READ | FILE_SHARE_WRITE | FILE_SHARE_DELETE,
+        nullptr, OPEN_EXISTING, FILE_ATTRIBUTE_NORMAL, nullptr);
+    if (file == INVALID_HANDLE_VALUE) {
+        throw std::runtime_error("Error opening file.");
+    }
+
+    BY_HANDLE_FILE_INFORMATION info;
+    BOOL succeeded = GetFileInformationByHandle(file, &info);
+    CloseHandle(file);
+    if (!succeeded) {
+        throw std::runtime_error("Error reading file.");
+    }
+
+    // FILETIME counts 100 ns ticks since 1601
+    uint64_t ticks = ((uint64_t)info.ftLastWriteTime.dwHighDateTime << 32) | info.ftLastWriteTime.dwLowDateTime;
+    FileIdentity identity;
+    identity.size = ((uint64_t)info.nFileSizeHigh << 32) | info.nFileSizeLow;
+    identity.mtime = ((int64_t)ticks - 116444736000000000ll) * 100;
+    identity.inode = ((uint64_t)info.nFileIndexHigh << 32) | info.nFileIndexLow;
+    identity.device = info.dwVolumeSerialNumber;
+    return identity;
+}
+
+#else
+
+FileIdentity GetFileIdentity(const fs::path& path) {
+    struct stat info;
+    if (stat(path.c_str(), &info) != 0) {
+        throw std::runtime_error("Error opening file.");
+    }
+
+    FileIdentity identity;
+    identity.size = (uint64_t)info.st_size;
+    identity.mtime = (int64_t)info.st_mtim.tv_sec * 1000000000ll + info.st_mtim.tv_nsec;
+    identity.inode = (uint64_t)info.st_ino;
+    identity.device = (uint64_t)info.st_dev;
+    return identity;
+}
+
+#endif
+
+static void ReplaceFileWithRetry(const fs::path& from, const fs::path& to) {
+    for (int attempt = 1;; ++attempt) {
+        std::error_code error;
+        fs::rename(from, to, error);
+        if (!error) {
+            return;
+        }
+
+        if (attempt == kReplaceAttempts) {
+            throw fs::filesystem_error("Error replacing cache file.", from, to, error);
+        }
+
+        std::this_thread::sleep_for(std::chrono::milliseconds(10));
+    }
+}
+
+static std::string Utf8(const fs::path& path) {
+    std::u8string text = path.u8string();
+    return std::string(text.begin(), text.end());
+}
+
+std::string Md2CacheKey(const fs::path& path) {
+    std::u8string key = fs::absolute(path).lexically_normal().generic_u8string();
+    return std::string(key.begin(), key.end());
+}
+
+Md2Cache::Md2Cache(const fs::path& path)
+: _path(path) {
+    Open();
+}
+
+// Data files sit next to the cache file as <cache>.d<random>
+std::string Md2Cache::DataPrefix() const {
+    return Utf8(_path.filename()) + ".d";
+}
+
+void Md2Cache::Open() {
+    _index.Close();
+    _dataPath.clear();
+    _entries = nullptr;
+    _strings = nullptr;
+    _entryCount = 0;
+
+    // The cache file only names the current data file
+    std::string name;
+    {
+        std::ifstream pointer(_path, std::ios::binary);
+        if (!pointer.is_open() || !std::getline(pointer, name)) {
+            // No cache yet
+            return;
+        }
+    }
+
+    if (name.rfind(DataPrefix(), 0) != 0 || fs::u8path(name).has_parent_path()) {
+        return;
+    }
+
+    // Kept even when the file turns out damaged, so Save removes it
+    _dataPath = _path.parent_path() / fs::u8path(name);
+    MappedFile index;
+    try {
+        index = MappedFile(_dataPath);
+    }
+    catch (const std::runtime_error&) {
+        // Removed by a writer that replaced it in the meantime
+        return;
+    }
+
+    std::span<const uint8_t> data = index.View<uint8_t>();
+    if (data.size() < sizeof(CacheHeader)) {
+        return;
+    }
+
+    // Anything inconsistent is treated as an empty cache, Save replaces it
+    const CacheHeader* header = reinterpret_cast<const CacheHeader*>(data.data());
+    size_t available = data.size() - sizeof(CacheHeader);
+    if (std::memcmp(header->magic, kCacheMagic, sizeof(kCacheMagic)) != 0 || header->version != kCacheVersion
+        || header->entryCount > available / sizeof(Entry) || header->stringsSize != available - header->entryCount * sizeof(Entry)
+        || header->checksum != Checksum(data.subspan(sizeof(CacheHeader)))) {
+        return;
+    }
+
+    const Entry* entries = reinterpret_cast<const Entry*>(data.data() + sizeof(CacheHeader));
+    for (size_t i = 0; i < header->entryCount; ++i) {
+        if (entries[i].pathOffset > header->stringsSize || entries[i].pathLength > header->stringsSize - entries[i].pathOffset) {
+            return;
+        }
+    }
+
+    _entries = entries;
+    _strings = reinterpret_cast<const char*>(entries + header->entryCount);
+    _entryCount = (size_t)header->entryCount;
+    _index = std::move(index);
+}
+
+bool Md2Cache::Lookup(const std::string& key, const FileIdentity& identity, std::span<uint8_t, kMd2DigestSize> digest) const {
+    uint64_t hash = HashKey(key);
+    std::shared_lock<std::shared_mutex> snapshot(_snapshotMutex);
+    const Entry* end = _entries + _entryCount;
+    const Entry* entry = std::lower_bound(_entries, end, hash, [](const Entry& entry, uint64_t hash) {
+        return entry.pathHash < hash;
+    });
+
+    for (; entry != end && entry->pathHash == hash; ++entry) {
+        if (entry->pathLength == key.size() && std::memcmp(_strings + entry->pathOffset, key.data(), key.size()) == 0) {
+            if (!(entry->identity == identity)) {
+                return false;
+            }
+
+            std::memcpy(digest.data(), entry->digest, kMd2DigestSize);
+            return true;
+        }
+    }
+
+    return false;
+}
+
+void Md2Cache::Store(const std::string& key, const FileIdentity& identity, std::span<const uint8_t, kMd2DigestSize> digest) {
+    Record record;
+    record.identity = identity;
+    std::memcpy(record.digest, digest.data(), kMd2DigestSize);
+    std::lock_guard<std::mutex> lock(_mutex);
+    _stored[key] = record;
+}
+
+void Md2Cache::Save() {
+    std::lock_guard<std::mutex> lock(_mutex);
+    // Merge, stored records replace mapped entries of the same path
+    std::vector<std::pair<uint64_t, std::string_view>> keys;
+    std::map<std::string_view, Record> records;
+    for (size_t i = 0; i < _entryCount; ++i) {
+        std::string_view key(_strings + _entries[i].pathOffset, (size_t)_entries[i].pathLength);
+        Record& record = records[key];
+        record.identity = _entries[i].identity;
+        std::memcpy(record.digest, _entries[i].digest, kMd2DigestSize);
+    }
+
+    for (const auto& [key, record] : _stored) {
+        records[key] = record;
+    }
+
+    size_t stringsSize = 0;
+    keys.reserve(records.size());
+    for (const auto& [key, record] : records) {
+        keys.emplace_back(HashKey(key), key);
+        stringsSize += key.size();
+    }
+
+    std::sort(keys.begin(), keys.end());
+
+    // Written next to the cache so the rename never crosses volumes. A new data file is written every time:
+    // Windows refuses to replace a file that is mapped, and readers in other processes keep theirs mapped.
+    std::string random = std::to_string(std::random_device()());
+    std::string dataName = DataPrefix() + random;
+    fs::path dataPath = _path.parent_path() / fs::u8path(dataName);
+    fs::path pointer = _path;
+    pointer += ".tmp" + random;
+    fs::path previous;
+    try {
+        {
+            size_t size = sizeof(CacheHeader) + keys.size() * sizeof(Entry) + stringsSize;
+            MappedWriter writer(dataPath, size);
+            std::span<uint8_t> data = writer.View<uint8_t>();
+            CacheHeader* header = reinterpret_cast<CacheHeader*>(data.data());
+            std::memcpy(header->magic, kCacheMagic, sizeof(kCacheMagic));
+            header->version = kCacheVersion;
+            header->entryCount = keys.size();
+            header->stringsSize = stringsSize;
+
+            Entry* entries = reinterpret_cast<Entry*>(data.data() + sizeof(CacheHeader));
+            char* strings = reinterpret_cast<char*>(entries + keys.size());
+            size_t offset = 0;
+            for (size_t i = 0; i < keys.size(); ++i) {
+                const Record& record = records[keys[i].second];
+                entries[i].pathHash = keys[i].first;
+                entries[i].pathOffset = offset;
+                entries[i].pathLength = keys[i].second.size();
+                entries[i].identity = record.identity;
+                std::memcpy(entries[i].digest, record.digest, kMd2DigestSize);
+                std::memcpy(strings + offset, keys[i].second.data(), keys[i].second.size());
+                offset += keys[i].second.size();
+            }
+
+            header->checksum = Checksum(data.subspan(sizeof(CacheHeader)));
+            writer.Flush();
+            writer.Commit(size);
+        }
+
+        WriteFile(pointer, std::span<const char>(dataName.data(), dataName.size()));
+        // Keys point into the old mapping, release it only after the new file is complete.
+        // Lookups read the old mapping too, they have to finish before it goes away.
+        records.clear();
+        keys.clear();
+        std::unique_lock<std::shared_mutex> snapshot(_snapshotMutex);
+        previous = _dataPath;
+        _index.Close();
+        ReplaceFileWithRetry(pointer, _path);
+        Open();
+    }
+    catch (...) {
+        std::error_code error;
+        fs::remove(dataPath, error);
+        fs::remove(pointer, error);
+        std::unique_lock<std::shared_mutex> snapshot(_snapshotMutex);
+        Open();
+        throw;
+    }
+
+    _stored.clear();
+    // Superseded data files. Removal fails while another process still maps one on Windows, the sweep retries later
+    std::error_code error;
+    if (!previous.empty()) {
+        fs::remove(previous, error);
+    }
+
+    RemoveStaleDataFiles();
+}
+
+void Md2Cache::RemoveStaleDataFiles() const {
+    std::string prefix = DataPrefix();
+    fs::path directory = _path.has_parent_path() ? _path.parent_path() : fs::path(".");
+    fs::file_time_type limit = fs::file_time_type::clock::now() - kStaleDataAge;
+    std::error_code error;
+    for (fs::directory_iterator it(directory, error), end; !error && it != end; it.increment(error)) {
+        fs::path path = it->path();
+        std::error_code timeError;
+        if (Utf8(path.filename()).rfind(prefix, 0) == 0 && path != _dataPath && fs::last_write_time(path, timeError) < limit && !timeError) {
+            std::error_code removeError;
+            fs::remove(path, removeError);
+        }
+    }
+}
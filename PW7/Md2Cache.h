@@ -0,0 +1,74 @@
+#pragma once
+#include <MappedFile.h>
+#include <cstddef>
+#include <cstdint>
+#include <filesystem>
+#include <map>
+#include <mutex>
+#include <shared_mutex>
+#include <span>
+#include <string>
+
+#include "HashMD2.h"
+
+// What the cache trusts to tell whether a file changed since it was hashed
+struct FileIdentity {
+    uint64_t size = 0;
+    int64_t mtime = 0; // Nanoseconds since the Unix epoch
+    uint64_t inode = 0;
+    uint64_t device = 0;
+
+    bool operator==(const FileIdentity&) const = default;
+};
+
+FileIdentity GetFileIdentity(const std::filesystem::path& path);
+// Absolute, normalized UTF-8 path used as the cache key
+std::string Md2CacheKey(const std::filesystem::path& path);
+
+// Persistent path -> MD2 index.
+// The cache file names the current data file next to it: a header, entries sorted by path hash and a pool of
+// path strings, all used in place through a read-only mapping. Save() writes a new data file and then renames a
+// new cache file over the old one, so readers in other processes always see a complete index and keep their
+// snapshot until they reopen. A mapped file is never replaced, which Windows would refuse.
+class Md2Cache {
+public:
+    // A missing or damaged cache file starts an empty cache
+    explicit Md2Cache(const std::filesystem::path& path);
+
+    Md2Cache(const Md2Cache&) = delete;
+    Md2Cache& operator=(const Md2Cache&) = delete;
+
+    // Binary search in the mapped snapshot under a shared lock, safe from any number of threads and next to Save
+    bool Lookup(const std::string& key, const FileIdentity& identity, std::span<uint8_t, kMd2DigestSize> digest) const;
+    // Thread-safe, stored entries are written out by Save
+    void Store(const std::string& key, const FileIdentity& identity, std::span<const uint8_t, kMd2DigestSize> digest);
+    // Merges stored entries into the index and maps the result. Concurrent writers do not merge, the last rename wins.
+    void Save();
+
+    size_t Size() const {
+        std::shared_lock<std::shared_mutex> snapshot(_snapshotMutex);
+        return _entryCount;
+    }
+
+private:
+    struct Entry;
+    struct Record {
+        FileIdentity identity;
+        uint8_t digest[kMd2DigestSize];
+    };
+
+    std::filesystem::path _path;
+    std::filesystem::path _dataPath;
+    MappedFile _index;
+    const Entry* _entries = nullptr;
+    const char* _strings = nullptr;
+    size_t _entryCount = 0;
+    std::map<std::string, Record> _stored;
+    std::mutex _mutex;
+    // Held exclusively only while Save swaps the mapping
+    mutable std::shared_mutex _snapshotMutex;
+
+    std::string DataPrefix() const;
+    void Open();
+    void RemoveStaleDataFiles() const;
+};
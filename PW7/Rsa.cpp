@@ -0,0 +1,144 @@
+#include "Rsa.h"
+#include <Instrumentation.h>
+#include <stdexcept>
+
+bool IsPrime(int n) {
+    if (n == 0 || n == 1) {
+        return false;
+    }
+
+    for (int i = 2; i <= n / 2; ++i) {
+        if (n % i == 0) {
+            return false;
+        }
+    }
+
+    return true;
+}
+
+int64_t GCD(int64_t a, int64_t b) {
+    while (a && b) {
+        if (a > b) {
+            a %= b;
+        }
+        else {
+            b %= a;
+        }
+    }
+
+    return a + b;
+}
+
+// Modular Exponentiation (x^y % p)
+int64_t ModExp(int64_t x, int64_t y, int64_t p) {
+    STIP_SCOPED_TIMER("rsa.modexp");
+    int64_t result = 1;
+    x = x % p;
+
+    while (y > 0) {
+        if (y & 1) {
+            result = (result * x) % p;
+        }
+
+        y = y >> 1;
+        x = (x * x) % p;
+    }
+
+    return result;
+}
+
+// Modular Multiplicative Inverse using Euclid Algorithm
+int64_t ModInv(int64_t a, int64_t m) {
+    int64_t m0 = m;
+    int64_t t;
+    int64_t q;
+    int64_t x0 = 0;
+    int64_t x1 = 1;
+
+    if (m == 1) {
+        return 0;
+    }
+
+    while (a > 1) {
+        q = a / m;
+        t = m;
+        m = a % m;
+        a = t;
+        t = x0;
+        x0 = x1 - q * x0;
+        x1 = t;
+    }
+
+    if (x1 < 0) {
+        x1 += m0;
+    }
+
+    return x1;
+}
+
+// Find e such that 1 < e < phi and gcd(e, phi) = 1
+int64_t FindE(int64_t phi) {
+    int64_t e = 2;
+
+    while (e < phi) {
+        if (GCD(e, phi) == 1) {
+            return e;
+        }
+        
+        e++;
+    }
+
+    return e;
+}
+
+// Function to generate keys
+void GenKeys(int64_t p, int64_t q, int64_t& n, int64_t& e, int64_t& d) {
+    n = p * q;
+    int64_t phi = (p - 1) * (q - 1);
+    // Choose e such that 1 < e < phi and gcd(e, phi) = 1
+    e = FindE(phi);
+    // Calculate d (private key) using modular inverse
+    d = ModInv(e, phi);
+}
+
+// Function to encrypt a byte using public key (n, e)
+int64_t EncryptSHA(int64_t data, int64_t exponent, int64_t privateKey) {
+    return ModExp(data, privateKey, exponent);
+}
+
+// Function to decrypt a byte using private key (n, d)
+int64_t DecryptSHA(int64_t data, int64_t exponent, int64_t publicKey) {
+    return ModExp(data, publicKey, exponent);
+}
+
+std::vector<int64_t> SignRSA(std::span<const uint8_t> data, int64_t exponent, int64_t privateKey) {
+    std::vector<int64_t> signature(data.size());
+    SignRSA(data, signature, exponent, privateKey);
+    return signature;
+}
+
+void SignRSA(std::span<const uint8_t> data, std::span<int64_t> signature, int64_t exponent, int64_t privateKey) {
+    STIP_SCOPED_TIMER("rsa.sign");
+    if (signature.size() < data.size()) {
+        throw std::runtime_error("Output buffer is too small.");
+    }
+
+    for (size_t i = 0; i < data.size(); ++i) {
+        signature[i] = EncryptSHA(data[i], exponent, privateKey);
+    }
+}
+
+bool VerifyRSA(std::span<const int64_t> signature, std::span<const uint8_t> hash, int64_t exponent, int64_t publicKey) {
+    STIP_SCOPED_TIMER("rsa.verify");
+    if (signature.size() != hash.size()) {
+        return false;
+    }
+
+    for (size_t i = 0; i < hash.size(); ++i) {
+        if (hash[i] != (uint8_t)DecryptSHA(signature[i], exponent, publicKey)) {
+            return false;
+        }
+    }
+
+    return true;
+}
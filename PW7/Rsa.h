@@ -0,0 +1,15 @@
+#pragma once
+#include <cstdint>
+#include <span>
+#include <vector>
+
+bool IsPrime(int n);
+int64_t GCD(int64_t a, int64_t b);
+// Modular Exponentiation (x^y % p)
+int64_t ModExp(int64_t x, int64_t y, int64_t p);
+int64_t ModInv(int64_t a, int64_t m);
+void GenKeys(int64_t p, int64_t q, int64_t& n, int64_t& e, int64_t& d);
+std::vector<int64_t> SignRSA(std::span<const uint8_t> data, int64_t exponent, int64_t privateKey);
+// Allocation-free form, signature needs data.size() elements
+void SignRSA(std::span<const uint8_t> data, std::span<int64_t> signature, int64_t exponent, int64_t privateKey);
+bool VerifyRSA(std::span<const int64_t> signature, std::span<const uint8_t> hash, int64_t exponent, int64_t publicKey);
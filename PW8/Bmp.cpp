@@ -0,0 +1,194 @@
+#include "Bmp.h"
+#include <Instrumentation.h>
+#include <Utils.h>
+#include <algorithm>
+#include <array>
+#include <bit>
+#include <cstring>
+#include <filesystem>
+#include <fstream>
+#include <span>
+#include <stdexcept>
+#if defined(_M_X64) || defined(_M_IX86) || defined(__SSE2__)
+#include <emmintrin.h>
+#endif
+
+// Checks the cover and returns the size of the resulting image
+static size_t BmpStegoSize(std::span<const uint8_t> cover, const char* message, const char* alphabet) {
+	if (cover.size() < sizeof(BMPFileHeader) + sizeof(BMPInfoHeader)) {
+		throw std::runtime_error("Format is not supported!");
+	}
+
+	auto fileHeader = reinterpret_cast<const BMPFileHeader*>(cover.data());
+	auto infoHeader = reinterpret_cast<const BMPInfoHeader*>(cover.data() + sizeof(BMPFileHeader));
+	size_t alphabetSize = strlen(alphabet);
+	size_t messageLen = strlen(message);
+	size_t paletteBytes = infoHeader->colorsUsed * sizeof(uint32_t);
+	// Dimensions are untrusted, 64-bit arithmetic keeps the products from wrapping
+	uint64_t stride = ((uint64_t)infoHeader->width + 3) / 4 * 4;
+	if (strncmp("BM", fileHeader->signature, 2)
+		|| infoHeader->headerSize != 40
+		|| infoHeader->depth != 8
+		|| infoHeader->compression != 0
+		|| infoHeader->width == 0
+		|| infoHeader->colorsUsed == 0
+		|| infoHeader->colorsUsed * (alphabetSize + 1) > UINT8_MAX + 1 // > 256 in general, but one additional palette is used for \0
+		|| (uint64_t)infoHeader->width * infoHeader->height < messageLen
+		|| fileHeader->offset < sizeof(BMPFileHeader) + sizeof(BMPInfoHeader) + paletteBytes
+		|| fileHeader->offset > cover.size()
+		|| cover.size() - fileHeader->offset < stride * infoHeader->height) {
+		throw std::runtime_error("Format is not supported!");
+	}
+
+	for (size_t i = 0; i < messageLen; ++i) {
+		if (strchr(alphabet, message[i]) == nullptr) {
+			throw std::runtime_error("Message contains a character outside of the alphabet!");
+		}
+	}
+
+	return cover.size() + alphabetSize * paletteBytes;
+}
+
+// Output must be BmpStegoSize() bytes long
+static void BmpEmbed(std::span<const uint8_t> cover, std::span<uint8_t> output, const char* message, const char* alphabet) {
+	auto coverHeader = reinterpret_cast<const BMPFileHeader*>(cover.data());
+	auto coverInfo = reinterpret_cast<const BMPInfoHeader*>(cover.data() + sizeof(BMPFileHeader));
+	size_t alphabetSize = strlen(alphabet);
+	size_t colorsUsed = coverInfo->colorsUsed;
+	size_t messageLen = strlen(message);
+	size_t paletteBytes = colorsUsed * sizeof(uint32_t);
+
+	// Duplicate palette for each letter between the original palette and the pixels
+	auto paletteOffset = cover.begin() + sizeof(BMPFileHeader) + sizeof(BMPInfoHeader);
+	auto out = std::copy(cover.begin(), cover.begin() + coverHeader->offset, output.begin());
+	for (size_t i = 0; i < alphabetSize; ++i) {
+		out = std::copy(paletteOffset, paletteOffset + paletteBytes, out);
+	}
+
+	std::copy(cover.begin() + coverHeader->offset, cover.end(), out);
+
+	auto fileHeader = reinterpret_cast<BMPFileHeader*>(output.data());
+	auto infoHeader = reinterpret_cast<BMPInfoHeader*>(output.data() + sizeof(BMPFileHeader));
+	fileHeader->size += paletteBytes * alphabetSize;
+	fileHeader->offset += paletteBytes * alphabetSize;
+	infoHeader->colorsUsed *= alphabetSize + 1;
+	infoHeader->colorsImportant = infoHeader->colorsUsed;
+
+	// Hide message
+	STIP_SCOPED_TIMER("bmp.embed");
+	STIP_COUNTER_ADD("bmp.embedded_letters", messageLen);
+	auto rowBegin = output.begin() + fileHeader->offset;
+	auto iter = output.begin() + fileHeader->offset;
+	size_t padding = (infoHeader->width + sizeof(uint32_t) - 1) / sizeof(uint32_t) * sizeof(uint32_t) - infoHeader->width;
+	for (size_t i = 0; i < messageLen; ++i) {
+		*iter = *iter + colorsUsed * (uint8_t)(strchr(alphabet, message[i]) - alphabet + 1); // Index of the letter + 1
+		++iter;
+		// Program handles only 8-bit depth so that will go
+		if (iter - rowBegin >= infoHeader->width) {
+			iter += padding;
+			rowBegin = iter;
+		}
+	}
+}
+
+void BmpHideMessage(std::vector<uint8_t>& data, const char* message, const char* alphabet) {
+	std::vector<uint8_t> output(BmpStegoSize(data, message, alphabet));
+	BmpEmbed(data, output, message, alphabet);
+	data.swap(output);
+}
+
+void BmpHideMessage(const std::filesystem::path& input, const std::filesystem::path& output, const char* message, const char* alphabet) {
+	// Cover is read straight from the page cache and the result is built in place in the output mapping
+	MappedFile cover(input);
+	MappedWriter stego(output, BmpStegoSize(cover.View<uint8_t>(), message, alphabet));
+	BmpEmbed(cover.View<uint8_t>(), stego.View<uint8_t>(), message, alphabet);
+}
+
+// Index of the first pixel that does not encode a letter: either from palette 0 (terminator) or outside the palette
+static size_t BmpFindTerminator(const uint8_t* pixels, size_t count, uint8_t paletteSize, uint32_t colorsUsed) {
+	// Letters occupy [paletteSize, colorsUsed), shifting by paletteSize turns the range check into one unsigned compare
+	uint8_t letterRange = (uint8_t)(colorsUsed - paletteSize);
+	size_t i = 0;
+#if defined(_M_X64) || defined(_M_IX86) || defined(__SSE2__)
+	__m128i shift = _mm_set1_epi8((char)paletteSize);
+	__m128i range = _mm_set1_epi8((char)letterRange);
+	for (; i + 16 <= count; i += 16) {
+		__m128i value = _mm_sub_epi8(_mm_loadu_si128(reinterpret_cast<const __m128i*>(pixels + i)), shift);
+		// value >= range <=> max(value, range) == value
+		int mask = _mm_movemask_epi8(_mm_cmpeq_epi8(_mm_max_epu8(value, range), value));
+		if (mask != 0) {
+			return i + std::countr_zero((unsigned)mask);
+		}
+	}
+#endif
+	for (; i < count; ++i) {
+		if ((uint8_t)(pixels[i] - paletteSize) >= letterRange) {
+			return i;
+		}
+	}
+
+	return count;
+}
+
+std::string BmpReadMessage(const std::filesystem::path& input, const char* alphabet) {
+	std::ifstream file(input, std::ios::binary);
+	if (!file.is_open()) {
+		throw std::runtime_error("Error opening file.");
+	}
+
+	// Only headers are read upfront, pixel rows are streamed until the terminator
+	BMPFileHeader fileHeader;
+	BMPInfoHeader infoHeader;
+	if (!file.read(reinterpret_cast<char*>(&fileHeader), sizeof(fileHeader))
+		|| !file.read(reinterpret_cast<char*>(&infoHeader), sizeof(infoHeader))) {
+		throw std::runtime_error("Format is not supported!");
+	}
+
+	uint64_t fileSize = std::filesystem::file_size(input);
+	size_t alphabetSize = strlen(alphabet);
+	if (strncmp("BM", fileHeader.signature, 2)
+		|| infoHeader.headerSize != 40
+		|| infoHeader.depth != 8
+		|| infoHeader.compression != 0
+		|| infoHeader.width == 0
+		|| infoHeader.colorsUsed == 0
+		|| infoHeader.colorsUsed > UINT8_MAX + 1
+		|| infoHeader.colorsUsed % (alphabetSize + 1) != 0
+		|| fileHeader.offset > fileSize) {
+		throw std::runtime_error("Format is not supported!");
+	}
+
+	// Pixel -> letter lookup, palette i (1-based) encodes alphabet[i - 1]
+	uint8_t paletteSize = (uint8_t)(infoHeader.colorsUsed / (alphabetSize + 1));
+	std::array<char, 256> decodeTable{};
+	for (uint32_t pixel = paletteSize; pixel < infoHeader.colorsUsed; ++pixel) {
+		decodeTable[pixel] = alphabet[pixel / paletteSize - 1];
+	}
+
+	// Get message
+	size_t stride = (infoHeader.width + sizeof(uint32_t) - 1) / sizeof(uint32_t) * sizeof(uint32_t);
+	// Width is untrusted, a row never needs more than what is left of the file
+	std::vector<uint8_t> row((size_t)std::min<uint64_t>(stride, fileSize - fileHeader.offset));
+	std::string message;
+	STIP_SCOPED_TIMER("bmp.extract");
+	file.seekg(fileHeader.offset);
+	for (uint32_t y = 0; y < infoHeader.height; ++y) {
+		STIP_COUNTER_ADD("bmp.extract.rows_read", 1);
+		file.read(reinterpret_cast<char*>(row.data()), row.size());
+		size_t read = (size_t)file.gcount();
+		size_t pixels = std::min<size_t>(infoHeader.width, read);
+		size_t length = BmpFindTerminator(row.data(), pixels, paletteSize, infoHeader.colorsUsed);
+		for (size_t i = 0; i < length; ++i) {
+			message.push_back(decodeTable[row[i]]);
+		}
+
+		STIP_COUNTER_ADD("bmp.extracted_letters", length);
+
+		// Decode till data is present
+		if (length < pixels || read < stride) {
+			break;
+		}
+	}
+
+	return message;
+}
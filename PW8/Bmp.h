@@ -0,0 +1,36 @@
+#pragma once
+#include <cstdint>
+#include <filesystem>
+#include <string>
+#include <vector>
+
+#pragma pack(push, 1)
+struct BMPFileHeader {
+	char signature[2];
+	uint32_t size;
+	uint16_t reserved1;
+	uint16_t reserved2;
+	uint32_t offset;
+};
+#pragma pack(pop)
+
+#pragma pack(push, 1)
+struct BMPInfoHeader {
+	uint32_t headerSize;
+	uint32_t width;
+	uint32_t height;
+	uint16_t planes;
+	uint16_t depth;
+	uint32_t compression;
+	uint32_t imageSize;
+	int32_t xResolution;
+	int32_t yResolution;
+	uint32_t colorsUsed;
+	uint32_t colorsImportant;
+};
+#pragma pack(pop)
+
+// Embeds message into an in-memory 8-bit BMP image
+void BmpHideMessage(std::vector<uint8_t>& data, const char* message, const char* alphabet);
+void BmpHideMessage(const std::filesystem::path& input, const std::filesystem::path& output, const char* message, const char* alphabet);
+std::string BmpReadMessage(const std::filesystem::path& input, const char* alphabet);
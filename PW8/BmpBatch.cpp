@@ -0,0 +1,109 @@
+#include "BmpBatch.h"
+#include "Bmp.h"
+#include <FileList.h>
+#include <ThreadPool.h>
+#include <Utils.h>
+#include <algorithm>
+#include <cstring>
+#include <future>
+#include <stdexcept>
+
+namespace fs = std::filesystem;
+
+static std::string ReadMessageFile(const fs::path& path) {
+	std::vector<uint8_t> data = ReadFile<uint8_t>(path);
+	std::string message(data.begin(), data.end());
+	while (!message.empty() && (message.back() == '\n' || message.back() == '\r')) {
+		message.pop_back();
+	}
+
+	return message;
+}
+
+std::vector<BmpBatchJob> BmpCollectJobs(const fs::path& source, const fs::path& outputDir, const std::string& defaultMessage) {
+	bool directory = fs::is_directory(source);
+	std::vector<FileListEntry> files = CollectFiles(source, false, [](const fs::path& path) {
+		return path.extension() == ".bmp" || path.extension() == ".BMP";
+	});
+
+	std::vector<BmpBatchJob> jobs;
+	for (FileListEntry& file : files) {
+		std::string message = defaultMessage;
+		if (file.hasField) {
+			message = std::move(file.field);
+		}
+		else if (directory) {
+			fs::path messagePath = fs::path(file.path).replace_extension(".txt");
+			if (fs::exists(messagePath)) {
+				message = ReadMessageFile(messagePath);
+			}
+		}
+
+		// Relative layout is kept under the output directory so equal names in different directories do not collide
+		jobs.push_back({ file.path, outputDir / file.relative, std::move(message) });
+	}
+
+	// Jobs run concurrently, two of them writing the same file would silently overwrite each other
+	std::vector<fs::path> outputs;
+	for (const BmpBatchJob& job : jobs) {
+		outputs.push_back(fs::weakly_canonical(fs::absolute(job.output)));
+	}
+
+	std::sort(outputs.begin(), outputs.end());
+	auto duplicate = std::adjacent_find(outputs.begin(), outputs.end());
+	if (duplicate != outputs.end()) {
+		throw std::runtime_error("Duplicate output path in manifest: " + duplicate->string());
+	}
+
+	return jobs;
+}
+
+// Output is opened with truncation, so writing over the cover would destroy it while it is mapped
+static bool IsSameFile(const fs::path& input, const fs::path& output) {
+	std::error_code error;
+	if (fs::exists(output, error)) {
+		return fs::equivalent(input, output, error);
+	}
+
+	return fs::weakly_canonical(fs::absolute(input)) == fs::weakly_canonical(fs::absolute(output));
+}
+
+void BmpRunBatch(const std::vector<BmpBatchJob>& jobs,
+	const char* alphabet,
+	size_t threadCount,
+	size_t memoryLimit,
+	const std::function<void(const BmpBatchResult&)>& onResult) {
+	ThreadPool pool(threadCount);
+	MemoryBudget budget(memoryLimit);
+	std::vector<std::future<BmpBatchResult>> results;
+	results.reserve(jobs.size());
+
+	for (const BmpBatchJob& job : jobs) {
+		results.emplace_back(pool.Submit([&job, &budget, alphabet]() {
+			BmpBatchResult result;
+			result.input = job.input;
+			size_t reserved = 0;
+			try {
+				// Cover and output mappings are both resident, output grows by at most a full 256-entry palette
+				if (IsSameFile(job.input, job.output)) {
+					throw std::runtime_error("Output path is the same as the input.");
+				}
+
+				reserved = budget.Acquire(2 * fs::file_size(job.input) + 256 * sizeof(uint32_t));
+				fs::create_directories(job.output.parent_path());
+				BmpHideMessage(job.input, job.output, job.message.c_str(), alphabet);
+				result.succeeded = true;
+			}
+			catch (const std::exception& e) {
+				result.error = e.what();
+			}
+
+			budget.Release(reserved);
+			return result;
+		}));
+	}
+
+	for (std::future<BmpBatchResult>& result : results) {
+		onResult(result.get());
+	}
+}
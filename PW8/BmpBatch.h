@@ -0,0 +1,30 @@
+#pragma once
+#include <cstddef>
+#include <filesystem>
+#include <functional>
+#include <string>
+#include <vector>
+
+struct BmpBatchJob {
+	std::filesystem::path input;
+	std::filesystem::path output;
+	std::string message;
+};
+
+struct BmpBatchResult {
+	std::filesystem::path input;
+	bool succeeded = false;
+	std::string error;
+};
+
+// Source is either a directory of *.bmp covers (message taken from a sibling <name>.txt, otherwise defaultMessage)
+// or a manifest file with one "<cover path>\t<message>" entry per line.
+// Relative manifest paths keep their layout under outputDir, throws if two jobs would write the same output
+std::vector<BmpBatchJob> BmpCollectJobs(const std::filesystem::path& source, const std::filesystem::path& outputDir, const std::string& defaultMessage);
+
+// Results are reported on the calling thread in job order
+void BmpRunBatch(const std::vector<BmpBatchJob>& jobs,
+	const char* alphabet,
+	size_t threadCount,
+	size_t memoryLimit,
+	const std::function<void(const BmpBatchResult&)>& onResult);
@@ -1,140 +1,71 @@
 #include <Windows.h>
+#include <shellapi.h>
 #include <Console.h>
 #include <Utils.h>
+#include <stdexcept>
+#include <string>
+#include <thread>
 #include <vector>
 
+#include "Bmp.h"
+#include "BmpBatch.h"
+
 constexpr const wchar_t* kInputFile = L"input.bmp";
 constexpr const wchar_t* kOutputFile = L"output.bmp";
 constexpr const char* kAlphabet = "abcdefghijklmnopqrstuvwxyz ";
 constexpr const char* kMessage = "never gonna give you up";
-
-#pragma pack(push, 1)
-struct BMPFileHeader {
-	char signature[2];
-	uint32_t size;
-	uint16_t reserved1;
-	uint16_t reserved2;
-	uint32_t offset;
-};
-#pragma pack(pop)
-
-#pragma pack(push, 1)
-struct BMPInfoHeader {
-	uint32_t headerSize;
-	uint32_t width;
-	uint32_t height;
-	uint16_t planes;
-	uint16_t depth;
-	uint32_t compression;
-	uint32_t imageSize;
-	int32_t xResolution;
-	int32_t yResolution;
-	uint32_t colorsUsed;
-	uint32_t colorsImportant;
-};
-#pragma pack(pop)
-
-void BmpHideMessage(const wchar_t* input, const wchar_t* output, const char* message, const char* alphabet) {
-	std::vector<uint8_t> data = ReadFile<uint8_t>(input);
-	if (data.size() < sizeof(BMPFileHeader) + sizeof(BMPInfoHeader)) {
-		std::runtime_error("Format is not supported!");
-	}
-
-	auto fileHeader = reinterpret_cast<BMPFileHeader*>(data.data());
-	auto infoHeader = reinterpret_cast<BMPInfoHeader*>(data.data() + sizeof(BMPFileHeader));
-	size_t alphabetSize = strlen(alphabet);
-	size_t colorsUsed = infoHeader->colorsUsed;
-	size_t messageLen = strlen(message);
-	if (strncmp("BM", fileHeader->signature, 2)
-		|| infoHeader->headerSize != 40
-		|| infoHeader->depth != 8
-		|| infoHeader->compression != 0
-		|| infoHeader->colorsUsed == 0
-		|| infoHeader->colorsUsed * (alphabetSize + 1) > UINT8_MAX + 1 // > 256 in general, but one additional palette is used for \0
-		|| infoHeader->width * infoHeader->height < messageLen) {
-		throw std::runtime_error("Format is not supported!");
-	}
-
-	// Add space for new palette colors and update pointers
-	data.reserve(data.size() + alphabetSize * infoHeader->colorsUsed * sizeof(uint32_t));
-	fileHeader = reinterpret_cast<BMPFileHeader*>(data.data());
-	infoHeader = reinterpret_cast<BMPInfoHeader*>(data.data() + sizeof(BMPFileHeader));
-
-	// Duplicate palette for each letter
-	auto paletteOffset = data.begin() + sizeof(BMPFileHeader) + sizeof(BMPInfoHeader);
-	for (int i = 0; i < alphabetSize; ++i) {
-		data.insert(data.begin() + fileHeader->offset,
-			paletteOffset,
-			paletteOffset + infoHeader->colorsUsed * sizeof(uint32_t));
+constexpr size_t kBatchMemoryLimit = 256 * 1024 * 1024;
+
+// PW8.exe <cover directory | manifest> <output directory> [threads]
+int RunBatch(int argc, wchar_t** argv) {
+	std::filesystem::path outputDir(argv[2]);
+	size_t threadCount = std::thread::hardware_concurrency();
+	if (argc > 3) {
+		try {
+			threadCount = std::stoul(argv[3]);
+		}
+		catch (const std::exception&) {
+			throw std::runtime_error("Invalid thread count.");
+		}
 	}
 
-	fileHeader->size += infoHeader->colorsUsed * alphabetSize * sizeof(uint32_t);
-	fileHeader->offset += infoHeader->colorsUsed * alphabetSize * sizeof(uint32_t);
-	infoHeader->colorsUsed *= alphabetSize + 1;
-	infoHeader->colorsImportant = infoHeader->colorsUsed;
+	std::filesystem::create_directories(outputDir);
+	std::vector<BmpBatchJob> jobs = BmpCollectJobs(argv[1], outputDir, kMessage);
 
-	// Hide message
-	auto rowBegin = data.begin() + fileHeader->offset;
-	auto iter = data.begin() + fileHeader->offset;
-	size_t padding = (infoHeader->width + sizeof(uint32_t) - 1) / sizeof(uint32_t) * sizeof(uint32_t) - infoHeader->width;
-	for (size_t i = 0; i < messageLen; ++i) {
-		*iter = *iter + colorsUsed * (uint8_t)(strchr(alphabet, message[i]) - alphabet + 1); // Index of the letter + 1
-		++iter;
-		// Program handles only 8-bit depth so that will go
-		if (iter - rowBegin >= infoHeader->width) {
-			iter += padding;
-			rowBegin = iter;
+	size_t failed = 0;
+	BmpRunBatch(jobs, kAlphabet, threadCount, kBatchMemoryLimit, [&failed](const BmpBatchResult& result) {
+		if (result.succeeded) {
+			Console::GetInstance()->WPrintF(L"OK     %s\n", result.input.wstring().c_str());
 		}
-	}
+		else {
+			++failed;
+			Console::GetInstance()->WPrintF(L"FAILED %s: %S\n", result.input.wstring().c_str(), result.error.c_str());
+		}
+	});
 
-	// Save data
-	WriteFile(output, data);
+	Console::GetInstance()->WPrintF(L"\nProcessed: %zu, failed: %zu\n", jobs.size(), failed);
+	return failed == 0 ? 0 : 1;
 }
 
-std::string BmpReadMessage(const wchar_t* input, const char* alphabet) {
-	std::vector<uint8_t> data = ReadFile<uint8_t>(input);
-	if (data.size() < sizeof(BMPFileHeader) + sizeof(BMPInfoHeader)) {
-		std::runtime_error("Format is not supported!");
-	}
-
-	auto fileHeader = reinterpret_cast<BMPFileHeader*>(data.data());
-	auto infoHeader = reinterpret_cast<BMPInfoHeader*>(data.data() + sizeof(BMPFileHeader));
-	size_t alphabetSize = strlen(alphabet);
-	size_t paletteSize = (infoHeader->colorsUsed - 1) / alphabetSize;
-	if (strncmp("BM", fileHeader->signature, 2)
-		|| infoHeader->headerSize != 40
-		|| infoHeader->depth != 8
-		|| infoHeader->compression != 0
-		|| infoHeader->colorsUsed == 0
-		|| infoHeader->colorsUsed % (alphabetSize + 1) != 0) {
-		throw std::runtime_error("Format is not supported!");
-	}
-
-	// Get message
-	auto rowBegin = data.begin() + fileHeader->offset;
-	auto iter = data.begin() + fileHeader->offset;
-	size_t padding = (infoHeader->width + sizeof(uint32_t) - 1) / sizeof(uint32_t) * sizeof(uint32_t) - infoHeader->width;
-	std::string message;
-	while (iter - data.begin() < data.size()) {
-		// Decode till data is present
-		size_t paletteIndex = *iter / paletteSize;
-		if (paletteIndex == 0) {
-			break;
+int WINAPI wWinMain(HINSTANCE, HINSTANCE, LPWSTR, int) {
+	int argc = 0;
+	wchar_t** argv = CommandLineToArgvW(GetCommandLineW(), &argc);
+	if (argv != nullptr && argc >= 3) {
+		int result = 0;
+		try {
+			result = RunBatch(argc, argv);
 		}
-
-		message.append(1, alphabet[paletteIndex - 1]);
-		++iter;
-		// Program handles only 8-bit depth so that will go
-		if (iter - rowBegin >= infoHeader->width) {
-			iter += padding;
-			rowBegin = iter;
+		catch (const std::exception& e) {
+			Console::GetInstance()->PrintF("FAILED: %s\n", e.what());
+			result = 1;
 		}
-	}
 
-	return message;
-}
+		LocalFree(argv);
+		Console::GetInstance()->Pause();
+		return result;
+	}
 
-int WINAPI wWinMain(HINSTANCE, HINSTANCE, LPWSTR, int) {
+	LocalFree(argv);
 	// Hide message
 	BmpHideMessage(kInputFile, kOutputFile, kMessage, kAlphabet);
 	// Read message
@@ -0,0 +1,73 @@
+#include <Windows.h>
+#include <shellapi.h>
+#include <Console.h>
+#include <Pipeline.h>
+#include <Utils.h>
+#include <filesystem>
+#include <stdexcept>
+#include <string>
+
+#include "Seal.h"
+
+constexpr const wchar_t* kInputFile = L"input.txt";
+constexpr const wchar_t* kKeyFile = L"key.txt";
+constexpr const wchar_t* kSealedFile = L"sealed.bin";
+constexpr const wchar_t* kUnsealedFile = L"unsealed.txt";
+// One frame per chunk, LZSS only looks WINDOW_SIZE back so larger frames barely compress better
+constexpr size_t kFrameSize = 64 * 1024;
+
+void Run(bool seal, const std::filesystem::path& input, const std::filesystem::path& output, const std::filesystem::path& keyPath) {
+    MappedFile keyFile(keyPath);
+    std::span<const uint32_t> key = keyFile.View<uint32_t>();
+    PipelineOptions options;
+    options.chunkSize = kFrameSize;
+
+    try {
+        if (seal) {
+            SealCodec codec(key, kFrameSize);
+            RunPipeline(input, output, codec, options);
+        }
+        else {
+            UnsealCodec codec(key);
+            RunPipeline(input, output, codec, options);
+        }
+    }
+    catch (...) {
+        // Never leave a partially unsealed file behind
+        std::error_code error;
+        std::filesystem::remove(output, error);
+        throw;
+    }
+}
+
+// Seal.exe seal|unseal <input> <output> [key]
+int WINAPI wWinMain(HINSTANCE, HINSTANCE, LPWSTR, int) {
+    int argc = 0;
+    wchar_t** argv = CommandLineToArgvW(GetCommandLineW(), &argc);
+    int result = 0;
+
+    try {
+        if (argv != nullptr && argc >= 4) {
+            std::wstring command(argv[1]);
+            if (command != L"seal" && command != L"unseal") {
+                throw std::runtime_error("Unknown command, expected seal or unseal.");
+            }
+
+            Run(command == L"seal", argv[2], argv[3], argc > 4 ? argv[4] : kKeyFile);
+        }
+        else {
+            Run(true, kInputFile, kSealedFile, kKeyFile);
+            Run(false, kSealedFile, kUnsealedFile, kKeyFile);
+        }
+
+        Console::GetInstance()->WPrintF(L"Done\n");
+    }
+    catch (const std::exception& e) {
+        Console::GetInstance()->PrintF("FAILED: %s\n", e.what());
+        result = 1;
+    }
+
+    LocalFree(argv);
+    Console::GetInstance()->Pause();
+    return result;
+}
@@ -0,0 +1,193 @@
+#include "Seal.h"
+#include <Cipher.h>
+#include <HashMD2.h>
+#include <Lzss.h>
+#include <algorithm>
+#include <cstring>
+#include <stdexcept>
+
+static void PutValue(uint8_t* target, uint32_t value) {
+    for (size_t i = 0; i < sizeof(uint32_t); ++i) {
+        target[i] = (uint8_t)((value >> (8 * i)) & 0xFF);
+    }
+}
+
+static uint32_t GetValue(const uint8_t* source) {
+    uint32_t result = 0;
+    for (size_t i = 0; i < sizeof(uint32_t); ++i) {
+        result |= (uint32_t)source[i] << (8 * i);
+    }
+
+    return result;
+}
+
+// Scratch words come from an arena sized for the largest frame so far, later frames never touch the heap
+static std::span<uint32_t> ScratchWords(std::unique_ptr<Arena>& arena, size_t count) {
+    if (!arena || arena->Capacity() < count * sizeof(uint32_t)) {
+        arena = std::make_unique<Arena>(count * sizeof(uint32_t));
+    }
+
+    arena->Reset();
+    return arena->Allocate<uint32_t>(count);
+}
+
+static std::array<uint32_t, 4> CopyKey(std::span<const uint32_t> key) {
+    if (key.size() < 4) {
+        throw std::runtime_error("Key is too short.");
+    }
+
+    std::array<uint32_t, 4> result;
+    std::copy_n(key.begin(), result.size(), result.begin());
+    return result;
+}
+
+// Largest cipher a frame of plainSize bytes can carry, LZSS worst case padded to whole blocks
+static size_t CipherBound(size_t plainSize) {
+    return PaddedSize((LzssEncodeBound(plainSize) + sizeof(uint32_t) - 1) / sizeof(uint32_t)) * sizeof(uint32_t);
+}
+
+SealCodec::SealCodec(std::span<const uint32_t> key, size_t frameSize)
+: _key(CopyKey(key))
+, _frameSize(frameSize) {
+    if (frameSize == 0 || frameSize > kSealMaxFrameSize) {
+        throw std::invalid_argument("Frame size is out of range.");
+    }
+}
+
+void SealCodec::Transform(std::span<const uint8_t> input, std::vector<uint8_t>& output) {
+    WriteHeader(output);
+    // The final chunk from the reader is often empty, only the end frame should be empty
+    while (!input.empty()) {
+        size_t size = std::min(input.size(), _frameSize);
+        WriteFrame(input.first(size), output);
+        input = input.subspan(size);
+    }
+}
+
+void SealCodec::Finish(std::vector<uint8_t>& output) {
+    WriteHeader(output);
+    WriteFrame(std::span<const uint8_t>(), output);
+}
+
+void SealCodec::WriteHeader(std::vector<uint8_t>& output) {
+    if (_headerWritten) {
+        return;
+    }
+
+    output.insert(output.end(), kSealMagic, kSealMagic + sizeof(kSealMagic));
+    output.push_back(kSealVersion);
+    output.resize(output.size() + kSealHeaderSize - sizeof(kSealMagic) - 1, 0);
+    PutValue(output.data() + output.size() - sizeof(uint32_t), (uint32_t)_frameSize);
+    _headerWritten = true;
+}
+
+void SealCodec::WriteFrame(std::span<const uint8_t> plain, std::vector<uint8_t>& output) {
+    // Compress straight into the word buffer, then pad to whole blocks and encrypt in place
+    std::span<uint32_t> scratch = ScratchWords(_scratch, CipherBound(plain.size()) / sizeof(uint32_t));
+    std::span<uint8_t> scratchBytes(reinterpret_cast<uint8_t*>(scratch.data()), scratch.size_bytes());
+    size_t compressedSize = LzssEncode(plain, scratchBytes);
+    std::span<uint32_t> cipher = scratch.first(PaddedSize((compressedSize + sizeof(uint32_t) - 1) / sizeof(uint32_t)));
+    std::fill(scratchBytes.begin() + compressedSize, scratchBytes.begin() + cipher.size_bytes(), 0);
+    EncryptBlocks(cipher, _key);
+
+    size_t frameStart = output.size();
+    size_t cipherSize = cipher.size_bytes();
+    output.resize(frameStart + kSealFrameHeaderSize + cipherSize + kSealDigestSize);
+    uint8_t* frame = output.data() + frameStart;
+    PutValue(frame, _sequence++);
+    PutValue(frame + 4, (uint32_t)plain.size());
+    PutValue(frame + 8, (uint32_t)compressedSize);
+    PutValue(frame + 12, (uint32_t)cipherSize);
+    if (cipherSize != 0) {
+        std::memcpy(frame + kSealFrameHeaderSize, cipher.data(), cipherSize);
+    }
+
+    // Digest covers the frame header too, so sizes and order cannot be tampered with
+    HashMD2(std::span<const uint8_t>(frame, kSealFrameHeaderSize + cipherSize),
+        std::span<uint8_t, kSealDigestSize>(frame + kSealFrameHeaderSize + cipherSize, kSealDigestSize));
+}
+
+UnsealCodec::UnsealCodec(std::span<const uint32_t> key)
+: _key(CopyKey(key)) {
+}
+
+void UnsealCodec::Transform(std::span<const uint8_t> input, std::vector<uint8_t>& output) {
+    _pending.insert(_pending.end(), input.begin(), input.end());
+    size_t index = 0;
+
+    if (!_headerRead) {
+        if (_pending.size() < kSealHeaderSize) {
+            return;
+        }
+
+        if (std::memcmp(_pending.data(), kSealMagic, sizeof(kSealMagic)) != 0 || _pending[sizeof(kSealMagic)] != kSealVersion) {
+            throw std::runtime_error("Not a sealed stream.");
+        }
+
+        // Header is not covered by a digest, the frame size is bounded like any other untrusted field
+        _frameSize = GetValue(_pending.data() + kSealHeaderSize - sizeof(uint32_t));
+        if (_frameSize == 0 || _frameSize > kSealMaxFrameSize) {
+            throw std::runtime_error("Corrupted sealed stream.");
+        }
+
+        index = kSealHeaderSize;
+        _headerRead = true;
+    }
+
+    while (!_finished && _pending.size() - index >= kSealFrameHeaderSize) {
+        const uint8_t* frame = _pending.data() + index;
+        uint32_t sequence = GetValue(frame);
+        uint32_t plainSize = GetValue(frame + 4);
+        uint32_t compressedSize = GetValue(frame + 8);
+        uint32_t cipherSize = GetValue(frame + 12);
+        // Rejected before the frame is buffered, a crafted frame can carry a valid digest since MD2 is unkeyed
+        if (plainSize > _frameSize || cipherSize % 16 != 0 || cipherSize > CipherBound(plainSize) || compressedSize > cipherSize) {
+            throw std::runtime_error("Corrupted sealed stream.");
+        }
+
+        // Frame continues in the next chunk
+        size_t frameSize = kSealFrameHeaderSize + cipherSize + kSealDigestSize;
+        if (_pending.size() - index < frameSize) {
+            break;
+        }
+
+        // Verify before anything is decrypted or decompressed
+        std::array<uint8_t, kSealDigestSize> digest;
+        HashMD2(std::span<const uint8_t>(frame, kSealFrameHeaderSize + cipherSize), digest);
+        if (!std::equal(digest.begin(), digest.end(), frame + kSealFrameHeaderSize + cipherSize) || sequence != _sequence) {
+            throw std::runtime_error("Integrity check failed.");
+        }
+
+        ++_sequence;
+        index += frameSize;
+        if (plainSize == 0) {
+            _finished = true;
+            break;
+        }
+
+        std::span<uint32_t> cipher = ScratchWords(_scratch, cipherSize / sizeof(uint32_t));
+        std::memcpy(cipher.data(), frame + kSealFrameHeaderSize, cipherSize);
+        DecryptBlocks(cipher, _key);
+
+        // A wrong key passes the digest, the tokens are validated and sized before any output is reserved
+        std::span<const uint8_t> compressed(reinterpret_cast<const uint8_t*>(cipher.data()), compressedSize);
+        if (LzssDecodedSize(compressed) != plainSize) {
+            throw std::runtime_error("Corrupted sealed stream.");
+        }
+
+        size_t outputStart = output.size();
+        output.resize(outputStart + plainSize);
+        LzssDecode(compressed, std::span<uint8_t>(output).subspan(outputStart));
+    }
+
+    _pending.erase(_pending.begin(), _pending.begin() + index);
+    if (_finished && !_pending.empty()) {
+        throw std::runtime_error("Unexpected data after the end of the sealed stream.");
+    }
+}
+
+void UnsealCodec::Finish(std::vector<uint8_t>& output) {
+    if (!_finished) {
+        throw std::runtime_error("Sealed stream is truncated.");
+    }
+}
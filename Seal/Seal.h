@@ -0,0 +1,58 @@
+#pragma once
+#include <Arena.h>
+#include <Pipeline.h>
+#include <array>
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+#include <span>
+#include <vector>
+
+// Sealed stream layout (little-endian):
+//   "STSL" | version u8 | 3 reserved bytes | frame size u32
+//   frame*: sequence u32 | plain size u32 | compressed size u32 | cipher size u32 | cipher | MD2(header + cipher)
+// Input is cut into frames of at most frame size bytes: LZSS-compressed on its own, zero-padded to the 128-bit
+// block and encrypted with the PW5 cipher. An empty frame marks the end of the stream, so truncation is detected.
+// The unsealer bounds every frame by the frame size before buffering it, so memory stays at one frame.
+constexpr char kSealMagic[4] = { 'S', 'T', 'S', 'L' };
+constexpr uint8_t kSealVersion = 2;
+constexpr size_t kSealHeaderSize = 12;
+constexpr size_t kSealMaxFrameSize = 64 * 1024 * 1024;
+constexpr size_t kSealFrameHeaderSize = 4 * sizeof(uint32_t);
+constexpr size_t kSealDigestSize = 16;
+
+class SealCodec : public ChunkCodec {
+public:
+    SealCodec(std::span<const uint32_t> key, size_t frameSize);
+
+    void Transform(std::span<const uint8_t> input, std::vector<uint8_t>& output) override;
+    void Finish(std::vector<uint8_t>& output) override;
+
+private:
+    std::array<uint32_t, 4> _key;
+    std::unique_ptr<Arena> _scratch;
+    size_t _frameSize;
+    uint32_t _sequence = 0;
+    bool _headerWritten = false;
+
+    void WriteHeader(std::vector<uint8_t>& output);
+    void WriteFrame(std::span<const uint8_t> plain, std::vector<uint8_t>& output);
+};
+
+// Verifies each frame's digest before it is decrypted and decompressed
+class UnsealCodec : public ChunkCodec {
+public:
+    explicit UnsealCodec(std::span<const uint32_t> key);
+
+    void Transform(std::span<const uint8_t> input, std::vector<uint8_t>& output) override;
+    void Finish(std::vector<uint8_t>& output) override;
+
+private:
+    std::array<uint32_t, 4> _key;
+    std::vector<uint8_t> _pending;
+    std::unique_ptr<Arena> _scratch;
+    size_t _frameSize = 0;
+    uint32_t _sequence = 0;
+    bool _headerRead = false;
+    bool _finished = false;
+};
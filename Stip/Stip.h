@@ -0,0 +1,15 @@
+#pragma once
+// Algorithm library (Stip.lib / libStip.a).
+// Every algorithm has an allocation-free form writing into caller spans, with a size query for the output.
+// Together with Arena for scratch buffers (as SealCodec uses it) and the reusable contexts (Md2Context, A5Encoder::Reset)
+// a per-record loop runs without heap allocations once warmed up.
+#include <Arena.h>
+#include <A5Encoder.h>
+#include <Bmp.h>
+#include <Cipher.h>
+#include <HashMD2.h>
+#include <Lzss.h>
+#include <LzssSearch.h>
+#include <Md2Batch.h>
+#include <Md2Cache.h>
+#include <Rsa.h>
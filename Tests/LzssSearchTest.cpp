@@ -0,0 +1,175 @@
+// Randomized differential test: LzssSearch against LzssDecode plus a naive search.
+// Exits with non-zero on the first mismatch.
+#include <algorithm>
+#include <cstdio>
+#include <cstring>
+#include <iterator>
+#include <random>
+#include <stdexcept>
+#include <vector>
+
+#include "Lzss.h"
+#include "LzssSearch.h"
+
+static std::vector<uint64_t> NaiveSearch(const std::vector<uint8_t>& data, const std::vector<uint8_t>& pattern) {
+    std::vector<uint64_t> offsets;
+    for (size_t i = 0; i + pattern.size() <= data.size(); ++i) {
+        if (std::memcmp(data.data() + i, pattern.data(), pattern.size()) == 0) {
+            offsets.push_back(i);
+        }
+    }
+
+    return offsets;
+}
+
+// Small alphabets and repeated phrases give the encoder plenty of matches, including overlapping ones
+static std::vector<uint8_t> MakeCorpus(std::mt19937& random, size_t size) {
+    std::vector<uint8_t> data;
+    data.reserve(size);
+    switch (random() % 4) {
+    case 0: {
+        uint32_t alphabet = 1 + random() % 4;
+        while (data.size() < size) {
+            data.push_back(static_cast<uint8_t>('a' + random() % alphabet));
+        }
+        break;
+    }
+    case 1: {
+        while (data.size() < size) {
+            data.insert(data.end(), 1 + random() % 300, static_cast<uint8_t>(random()));
+        }
+        break;
+    }
+    case 2: {
+        static const char* kWords[] = { "the ", "LZSS ", "window ", "search ", "abab", "aab", "\n" };
+        while (data.size() < size) {
+            const char* word = kWords[random() % std::size(kWords)];
+            data.insert(data.end(), word, word + std::strlen(word));
+        }
+        break;
+    }
+    default:
+        while (data.size() < size) {
+            data.push_back(static_cast<uint8_t>(random()));
+        }
+        break;
+    }
+
+    data.resize(size);
+    return data;
+}
+
+static std::vector<uint8_t> MakePattern(std::mt19937& random, const std::vector<uint8_t>& data) {
+    size_t length = 1 + random() % 12;
+    if (random() % 8 == 0) {
+        length = 1 + random() % (2 * WINDOW_SIZE);
+    }
+
+    // Mostly taken from the data so there is something to find
+    if (!data.empty() && random() % 4 != 0) {
+        length = std::min(length, data.size());
+        size_t start = random() % (data.size() - length + 1);
+        return std::vector<uint8_t>(data.begin() + start, data.begin() + start + length);
+    }
+
+    std::vector<uint8_t> pattern(length);
+    for (uint8_t& byte : pattern) {
+        byte = static_cast<uint8_t>('a' + random() % 3);
+    }
+
+    return pattern;
+}
+
+static std::vector<uint64_t> ChunkedSearch(std::mt19937& random, const std::vector<uint8_t>& encoded,
+    const std::vector<uint8_t>& pattern) {
+    std::vector<uint64_t> offsets;
+    LzssSearcher searcher(pattern, [&offsets](uint64_t offset) {
+        offsets.push_back(offset);
+    });
+    for (size_t i = 0; i < encoded.size();) {
+        size_t count = std::min<size_t>(encoded.size() - i, random() % 64 == 0 ? random() % 200000 : random() % 20);
+        searcher.Feed(std::span<const uint8_t>(encoded.data() + i, count));
+        i += count;
+    }
+
+    searcher.Finish();
+    return offsets;
+}
+
+static bool Throws(const std::vector<uint8_t>& encoded, const std::vector<uint8_t>& pattern) {
+    try {
+        LzssSearch(encoded, pattern);
+    }
+    catch (const std::runtime_error&) {
+        return true;
+    }
+
+    return false;
+}
+
+static int Fail(int iteration, const char* what) {
+    std::printf("FAILED: iteration %d: %s\n", iteration, what);
+    return 1;
+}
+
+int main() {
+    std::mt19937 random(0x4C5A5353);
+    for (int iteration = 0; iteration < 300; ++iteration) {
+        size_t size = random() % 8 == 0 ? random() % 40000 : random() % 3000;
+        std::vector<uint8_t> data = MakeCorpus(random, size);
+        std::vector<uint8_t> pattern = MakePattern(random, data);
+        std::vector<uint8_t> encoded = LzssEncode(data);
+        if (LzssDecode(encoded) != data) {
+            return Fail(iteration, "LzssDecode roundtrip");
+        }
+
+        std::vector<uint64_t> expected = NaiveSearch(data, pattern);
+        if (LzssSearch(encoded, pattern) != expected) {
+            return Fail(iteration, "whole stream");
+        }
+
+        if (ChunkedSearch(random, encoded, pattern) != expected) {
+            return Fail(iteration, "chunked stream");
+        }
+
+        // Cut inside the last token
+        if (!encoded.empty()) {
+            std::vector<uint8_t> truncated(encoded.begin(), encoded.end() - 1);
+            if (!Throws(truncated, pattern)) {
+                return Fail(iteration, "truncated stream accepted");
+            }
+        }
+
+        std::vector<uint8_t> corrupted = encoded;
+        corrupted.push_back(2);
+        if (!Throws(corrupted, pattern)) {
+            return Fail(iteration, "bad marker accepted");
+        }
+    }
+
+    // Long matches decode past the chunk size within one Feed, so the searcher has to drain
+    std::vector<uint8_t> runs;
+    for (size_t i = 0; runs.size() < 3 * LzssSearcher::kChunkSize; ++i) {
+        runs.insert(runs.end(), 1000 + i % 7, static_cast<uint8_t>('a' + i % 3));
+    }
+
+    std::vector<uint8_t> encodedRuns = LzssEncode(runs);
+    for (std::vector<uint8_t> pattern : { std::vector<uint8_t>{ 'a', 'b' }, std::vector<uint8_t>(900, 'c') }) {
+        if (LzssSearch(encodedRuns, pattern) != NaiveSearch(runs, pattern)) {
+            return Fail(-1, "drained stream");
+        }
+    }
+
+    // A match reaching before the start of the stream
+    std::vector<uint8_t> bad = { MATCH_MARKER, 5, 0, 0, 0, 3, 0, 0, 0 };
+    if (!Throws(bad, { 'a' })) {
+        return Fail(-1, "bad match index accepted");
+    }
+
+    if (!Throws({}, {})) {
+        return Fail(-1, "empty pattern accepted");
+    }
+
+    std::printf("OK\n");
+    return 0;
+}
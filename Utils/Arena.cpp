@@ -0,0 +1,28 @@
+#include "Arena.h"
+#include <stdexcept>
+
+Arena::Arena(size_t capacity)
+: _storage(new uint8_t[capacity])
+, _buffer(_storage.get(), capacity) {
+}
+
+Arena::Arena(std::span<uint8_t> buffer)
+: _buffer(buffer) {
+}
+
+void* Arena::AllocateBytes(size_t count, size_t elementSize, size_t alignment) {
+    // A wrapped product would hand out a few bytes for a span of count elements
+    if (count > SIZE_MAX / elementSize) {
+        throw std::runtime_error("Arena is exhausted.");
+    }
+
+    size_t size = count * elementSize;
+    uintptr_t base = reinterpret_cast<uintptr_t>(_buffer.data());
+    size_t offset = (size_t)(((base + _used + alignment - 1) & ~(uintptr_t)(alignment - 1)) - base);
+    if (offset > _buffer.size() || size > _buffer.size() - offset) {
+        throw std::runtime_error("Arena is exhausted.");
+    }
+
+    _used = offset + size;
+    return _buffer.data() + offset;
+}
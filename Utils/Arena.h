@@ -0,0 +1,44 @@
+#pragma once
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+#include <span>
+#include <type_traits>
+
+// Bump allocator for per-record scratch and output buffers.
+// Allocate while handling a record, then Reset() - steady state never touches the heap.
+class Arena {
+public:
+    // Owns a single block allocated up front
+    explicit Arena(size_t capacity);
+    // Uses caller memory, the arena never allocates at all
+    explicit Arena(std::span<uint8_t> buffer);
+
+    Arena(const Arena&) = delete;
+    Arena& operator=(const Arena&) = delete;
+
+    // Memory is not initialized, throws when the arena is exhausted
+    template <typename T, typename = std::enable_if_t<std::is_trivially_copyable_v<T>>>
+    std::span<T> Allocate(size_t count) {
+        return std::span<T>(static_cast<T*>(AllocateBytes(count, sizeof(T), alignof(T))), count);
+    }
+
+    void Reset() {
+        _used = 0;
+    }
+
+    size_t Used() const {
+        return _used;
+    }
+
+    size_t Capacity() const {
+        return _buffer.size();
+    }
+
+private:
+    std::unique_ptr<uint8_t[]> _storage;
+    std::span<uint8_t> _buffer;
+    size_t _used = 0;
+
+    void* AllocateBytes(size_t count, size_t elementSize, size_t alignment);
+};
@@ -0,0 +1,68 @@
+#include "FileList.h"
+#include <algorithm>
+#include <fstream>
+#include <stdexcept>
+
+namespace fs = std::filesystem;
+
+template <typename Iterator>
+static void CollectDirectory(const fs::path& source, const std::function<bool(const fs::path&)>& filter,
+    std::vector<FileListEntry>& files) {
+    for (const fs::directory_entry& entry : Iterator(source)) {
+        if (entry.is_regular_file() && (!filter || filter(entry.path()))) {
+            files.push_back({ entry.path(), entry.path().lexically_relative(source) });
+        }
+    }
+
+    // Directory iteration order is unspecified
+    std::sort(files.begin(), files.end(), [](const FileListEntry& a, const FileListEntry& b) {
+        return a.path < b.path;
+    });
+}
+
+std::vector<FileListEntry> CollectFiles(const fs::path& source,
+    bool recursive,
+    const std::function<bool(const fs::path&)>& filter) {
+    std::vector<FileListEntry> files;
+    if (fs::is_directory(source)) {
+        if (recursive) {
+            CollectDirectory<fs::recursive_directory_iterator>(source, filter, files);
+        }
+        else {
+            CollectDirectory<fs::directory_iterator>(source, filter, files);
+        }
+
+        return files;
+    }
+
+    std::ifstream list(source);
+    if (!list.is_open()) {
+        throw std::runtime_error("Error opening file list.");
+    }
+
+    fs::path base = source.parent_path();
+    std::string line;
+    while (std::getline(list, line)) {
+        if (!line.empty() && line.back() == '\r') {
+            line.pop_back();
+        }
+
+        if (line.empty()) {
+            continue;
+        }
+
+        FileListEntry file;
+        size_t tab = line.find('\t');
+        fs::path path = fs::u8path(line.substr(0, tab)).lexically_normal();
+        file.path = base / path;
+        file.relative = !path.empty() && path.is_relative() && *path.begin() != ".." ? path : path.filename();
+        if (tab != std::string::npos) {
+            file.field = line.substr(tab + 1);
+            file.hasField = true;
+        }
+
+        files.push_back(std::move(file));
+    }
+
+    return files;
+}
@@ -0,0 +1,21 @@
+#pragma once
+#include <filesystem>
+#include <functional>
+#include <string>
+#include <vector>
+
+struct FileListEntry {
+    std::filesystem::path path;
+    // Location under the source, only the file name when a list entry points outside of it
+    std::filesystem::path relative;
+    // Text after the first tab of a list line, empty for directories
+    std::string field;
+    bool hasField = false;
+};
+
+// Source is either a directory or a list file with one "<path>[\t<field>]" entry per line.
+// Directory entries are the regular files accepted by filter, sorted by path so reports are reproducible.
+// Relative list paths are resolved against the list location.
+std::vector<FileListEntry> CollectFiles(const std::filesystem::path& source,
+    bool recursive,
+    const std::function<bool(const std::filesystem::path&)>& filter = nullptr);
@@ -0,0 +1,161 @@
+#include "Instrumentation.h"
+
+#ifdef STIP_INSTRUMENTATION
+
+#include <cstdio>
+#include <cstdlib>
+#include <mutex>
+#include <stdexcept>
+#include <string>
+#include <vector>
+
+namespace Instrumentation {
+    namespace {
+        struct Metric {
+            std::string name;
+            Kind kind;
+            size_t slot;
+        };
+
+        struct Registry {
+            std::mutex mutex;
+            std::vector<Metric> metrics;
+            size_t usedSlots = 0;
+            std::vector<ThreadSlots*> liveThreads;
+            // Totals of threads that already exited
+            uint64_t retired[kMaxSlots] = {};
+        };
+
+        Registry& GetRegistry() {
+            static Registry registry;
+            return registry;
+        }
+
+        void Snapshot(Registry& registry, uint64_t* totals) {
+            for (size_t i = 0; i < kMaxSlots; ++i) {
+                totals[i] = registry.retired[i];
+            }
+
+            for (ThreadSlots* thread : registry.liveThreads) {
+                for (size_t i = 0; i < kMaxSlots; ++i) {
+                    totals[i] += thread->values[i].load(std::memory_order_relaxed);
+                }
+            }
+        }
+
+        class ExitReporter {
+        public:
+            ExitReporter() {
+                // Registry has to outlive the reporter, so it is constructed first
+                GetRegistry();
+            }
+
+            ~ExitReporter() {
+                const char* output = std::getenv("STIP_INSTRUMENTATION_OUTPUT");
+                try {
+                    Dump(output != nullptr ? output : "instrumentation.json");
+                }
+                catch (...) {
+                    // Nothing sensible left to do while the process exits
+                }
+            }
+        };
+
+        ExitReporter exitReporter;
+    }
+
+    size_t Register(const char* name, Kind kind) {
+        Registry& registry = GetRegistry();
+        std::lock_guard<std::mutex> lock(registry.mutex);
+        for (const Metric& metric : registry.metrics) {
+            if (metric.name == name) {
+                return metric.slot;
+            }
+        }
+
+        size_t slots = kind == Kind::Timer ? 2 : 1;
+        if (registry.usedSlots + slots > kMaxSlots) {
+            throw std::runtime_error("Too many instrumentation metrics.");
+        }
+
+        registry.metrics.push_back({ name, kind, registry.usedSlots });
+        registry.usedSlots += slots;
+        return registry.metrics.back().slot;
+    }
+
+    ThreadSlots::ThreadSlots() {
+        Registry& registry = GetRegistry();
+        std::lock_guard<std::mutex> lock(registry.mutex);
+        registry.liveThreads.push_back(this);
+    }
+
+    ThreadSlots::~ThreadSlots() {
+        Registry& registry = GetRegistry();
+        std::lock_guard<std::mutex> lock(registry.mutex);
+        for (size_t i = 0; i < kMaxSlots; ++i) {
+            registry.retired[i] += values[i].load(std::memory_order_relaxed);
+        }
+
+        std::erase(registry.liveThreads, this);
+    }
+
+    ThreadSlots& Local() {
+        thread_local ThreadSlots slots;
+        return slots;
+    }
+
+    void Dump(const std::filesystem::path& path) {
+        Registry& registry = GetRegistry();
+        std::vector<Metric> metrics;
+        uint64_t totals[kMaxSlots];
+        {
+            std::lock_guard<std::mutex> lock(registry.mutex);
+            metrics = registry.metrics;
+            Snapshot(registry, totals);
+        }
+
+        if (metrics.empty()) {
+            return;
+        }
+
+        std::FILE* file = std::fopen(path.string().c_str(), "w");
+        if (file == nullptr) {
+            throw std::runtime_error("Error opening file for writing.");
+        }
+
+        if (path.extension() == ".txt") {
+            std::fprintf(file, "%-32s %16s %16s %14s\n", "metric", "count", "total ms", "avg ns");
+            for (const Metric& metric : metrics) {
+                if (metric.kind == Kind::Counter) {
+                    std::fprintf(file, "%-32s %16llu\n", metric.name.c_str(), (unsigned long long)totals[metric.slot]);
+                }
+                else {
+                    uint64_t ns = totals[metric.slot];
+                    uint64_t calls = totals[metric.slot + 1];
+                    std::fprintf(file, "%-32s %16llu %16.3f %14.1f\n", metric.name.c_str(), (unsigned long long)calls,
+                        ns / 1e6, calls == 0 ? 0.0 : (double)ns / calls);
+                }
+            }
+        }
+        else {
+            std::fprintf(file, "{\n");
+            for (size_t i = 0; i < metrics.size(); ++i) {
+                const Metric& metric = metrics[i];
+                const char* separator = i + 1 < metrics.size() ? "," : "";
+                if (metric.kind == Kind::Counter) {
+                    std::fprintf(file, "  \"%s\": {\"count\": %llu}%s\n", metric.name.c_str(),
+                        (unsigned long long)totals[metric.slot], separator);
+                }
+                else {
+                    std::fprintf(file, "  \"%s\": {\"calls\": %llu, \"total_ns\": %llu}%s\n", metric.name.c_str(),
+                        (unsigned long long)totals[metric.slot + 1], (unsigned long long)totals[metric.slot], separator);
+                }
+            }
+            std::fprintf(file, "}\n");
+        }
+
+        std::fclose(file);
+    }
+}
+
+#endif
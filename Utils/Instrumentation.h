@@ -0,0 +1,86 @@
+#pragma once
+// Hot-path counters and timers. Everything compiles to nothing unless STIP_INSTRUMENTATION is defined.
+// When enabled, each thread accumulates into its own slots and a summary is written at exit to the file
+// named by the STIP_INSTRUMENTATION_OUTPUT environment variable (instrumentation.json by default,
+// a .txt extension switches to a plain-text table).
+//
+//     STIP_COUNTER_ADD("lzss.tokens", 1);
+//     STIP_SCOPED_TIMER("rsa.modexp");
+
+#ifdef STIP_INSTRUMENTATION
+
+#include <atomic>
+#include <chrono>
+#include <cstddef>
+#include <cstdint>
+#include <filesystem>
+
+namespace Instrumentation {
+    enum class Kind {
+        Counter,
+        Timer
+    };
+
+    constexpr size_t kMaxSlots = 256;
+
+    // Returns the first slot of the metric, timers take two slots (total ns, calls). Same name -> same slots.
+    size_t Register(const char* name, Kind kind);
+
+    // Slots are written by their own thread only, relaxed load + store keeps increments free of locked instructions
+    // while Snapshot() can still read them from another thread
+    struct ThreadSlots {
+        std::atomic<uint64_t> values[kMaxSlots] = {};
+
+        ThreadSlots();
+        ~ThreadSlots();
+    };
+
+    ThreadSlots& Local();
+
+    inline void Add(size_t slot, uint64_t value) {
+        std::atomic<uint64_t>& target = Local().values[slot];
+        target.store(target.load(std::memory_order_relaxed) + value, std::memory_order_relaxed);
+    }
+
+    class ScopedTimer {
+    public:
+        explicit ScopedTimer(size_t slot)
+        : _slot(slot)
+        , _begin(std::chrono::steady_clock::now()) {
+        }
+
+        ~ScopedTimer() {
+            auto elapsed = std::chrono::duration_cast<std::chrono::nanoseconds>(std::chrono::steady_clock::now() - _begin);
+            Add(_slot, (uint64_t)elapsed.count());
+            Add(_slot + 1, 1);
+        }
+
+    private:
+        size_t _slot;
+        std::chrono::steady_clock::time_point _begin;
+    };
+
+    // Writes totals over all threads seen so far
+    void Dump(const std::filesystem::path& path);
+}
+
+#define STIP_INSTRUMENTATION_CONCAT_(a, b) a##b
+#define STIP_INSTRUMENTATION_CONCAT(a, b) STIP_INSTRUMENTATION_CONCAT_(a, b)
+
+#define STIP_COUNTER_ADD(name, value) \
+    do { \
+        static const size_t stipCounterSlot = Instrumentation::Register(name, Instrumentation::Kind::Counter); \
+        Instrumentation::Add(stipCounterSlot, (uint64_t)(value)); \
+    } while (0)
+
+#define STIP_SCOPED_TIMER(name) \
+    static const size_t STIP_INSTRUMENTATION_CONCAT(stipTimerSlot, __LINE__) = \
+        Instrumentation::Register(name, Instrumentation::Kind::Timer); \
+    Instrumentation::ScopedTimer STIP_INSTRUMENTATION_CONCAT(stipTimer, __LINE__)(STIP_INSTRUMENTATION_CONCAT(stipTimerSlot, __LINE__))
+
+#else
+
+#define STIP_COUNTER_ADD(name, value) do { } while (0)
+#define STIP_SCOPED_TIMER(name) do { } while (0)
+
+#endif
@@ -0,0 +1,206 @@
+#include "MappedFile.h"
+#include <utility>
+
+#ifdef _WIN32
+#define NOMINMAX
+#include <Windows.h>
+#else
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#endif
+
+MappedFile::MappedFile(const std::filesystem::path& filename, Mode mode) {
+    Map(filename, mode, nullptr);
+}
+
+MappedFile::~MappedFile() {
+    Close();
+}
+
+MappedFile::MappedFile(MappedFile&& other) noexcept {
+    *this = std::move(other);
+}
+
+MappedFile& MappedFile::operator=(MappedFile&& other) noexcept {
+    if (this != &other) {
+        Close();
+        std::swap(_data, other._data);
+        std::swap(_size, other._size);
+        std::swap(_mode, other._mode);
+        std::swap(_file, other._file);
+#ifdef _WIN32
+        std::swap(_mapping, other._mapping);
+#endif
+    }
+
+    return *this;
+}
+
+#ifdef _WIN32
+
+void MappedFile::Map(const std::filesystem::path& filename, Mode mode, const size_t* resize) {
+    _mode = mode;
+    DWORD access = mode == Mode::ReadWrite ? GENERIC_READ | GENERIC_WRITE : GENERIC_READ;
+    DWORD disposition = resize != nullptr ? CREATE_ALWAYS : OPEN_EXISTING;
+    _file = CreateFileW(filename.c_str(), access, FILE_SHARE_READ, nullptr, disposition, FILE_ATTRIBUTE_NORMAL, nullptr);
+    if (_file == INVALID_HANDLE_VALUE) {
+        _file = nullptr;
+        throw std::runtime_error("Error opening file.");
+    }
+
+    LARGE_INTEGER size;
+    if (resize != nullptr) {
+        size.QuadPart = (LONGLONG)*resize;
+        if (!SetFilePointerEx(_file, size, nullptr, FILE_BEGIN) || !SetEndOfFile(_file)) {
+            Close();
+            throw std::runtime_error("Error resizing file.");
+        }
+    }
+    else if (!GetFileSizeEx(_file, &size)) {
+        Close();
+        throw std::runtime_error("Error reading file.");
+    }
+
+    _size = (size_t)size.QuadPart;
+    // Empty files cannot be mapped, they are exposed as empty views
+    if (_size == 0) {
+        return;
+    }
+
+    _mapping = CreateFileMappingW(_file, nullptr, mode == Mode::ReadWrite ? PAGE_READWRITE : PAGE_READONLY, 0, 0, nullptr);
+    if (_mapping == nullptr) {
+        Close();
+        throw std::runtime_error("Error mapping file.");
+    }
+
+    _data = static_cast<uint8_t*>(MapViewOfFile(_mapping, mode == Mode::ReadWrite ? FILE_MAP_WRITE : FILE_MAP_READ, 0, 0, 0));
+    if (_data == nullptr) {
+        Close();
+        throw std::runtime_error("Error mapping file.");
+    }
+}
+
+void MappedFile::Flush() {
+    if (_data != nullptr && _mode == Mode::ReadWrite) {
+        FlushViewOfFile(_data, 0);
+    }
+}
+
+void MappedFile::Close() {
+    if (_data != nullptr) {
+        UnmapViewOfFile(_data);
+        _data = nullptr;
+    }
+
+    if (_mapping != nullptr) {
+        CloseHandle(_mapping);
+        _mapping = nullptr;
+    }
+
+    if (_file != nullptr) {
+        CloseHandle(_file);
+        _file = nullptr;
+    }
+
+    _size = 0;
+}
+
+#else
+
+void MappedFile::Map(const std::filesystem::path& filename, Mode mode, const size_t* resize) {
+    _mode = mode;
+    int flags = mode == Mode::ReadWrite ? O_RDWR : O_RDONLY;
+    if (resize != nullptr) {
+        flags |= O_CREAT | O_TRUNC;
+    }
+
+    _file = open(filename.c_str(), flags | O_CLOEXEC, 0644);
+    if (_file < 0) {
+        throw std::runtime_error("Error opening file.");
+    }
+
+    if (resize != nullptr) {
+        if (ftruncate(_file, (off_t)*resize) != 0) {
+            Close();
+            throw std::runtime_error("Error resizing file.");
+        }
+
+        _size = *resize;
+    }
+    else {
+        struct stat info;
+        if (fstat(_file, &info) != 0) {
+            Close();
+            throw std::runtime_error("Error reading file.");
+        }
+
+        _size = (size_t)info.st_size;
+    }
+
+    // Empty files cannot be mapped, they are exposed as empty views
+    if (_size == 0) {
+        return;
+    }
+
+    int protection = mode == Mode::ReadWrite ? PROT_READ | PROT_WRITE : PROT_READ;
+    void* data = mmap(nullptr, _size, protection, MAP_SHARED, _file, 0);
+    if (data == MAP_FAILED) {
+        Close();
+        throw std::runtime_error("Error mapping file.");
+    }
+
+    _data = static_cast<uint8_t*>(data);
+    // Whole files are almost always consumed front to back
+    madvise(_data, _size, MADV_SEQUENTIAL);
+}
+
+void MappedFile::Flush() {
+    if (_data != nullptr && _mode == Mode::ReadWrite) {
+        msync(_data, _size, MS_SYNC);
+    }
+}
+
+void MappedFile::Close() {
+    if (_data != nullptr) {
+        munmap(_data, _size);
+        _data = nullptr;
+    }
+
+    if (_file >= 0) {
+        close(_file);
+        _file = -1;
+    }
+
+    _size = 0;
+}
+
+#endif
+
+MappedWriter::MappedWriter(const std::filesystem::path& filename, size_t size) {
+    Map(filename, Mode::ReadWrite, &size);
+}
+
+void MappedWriter::Commit(size_t size) {
+    if (size > _size) {
+        throw std::runtime_error("Commit exceeds the reserved size.");
+    }
+
+#ifdef _WIN32
+    // Mapped files cannot be truncated on Windows, drop the view first
+    HANDLE file = _file;
+    _file = nullptr;
+    Close();
+    LARGE_INTEGER end;
+    end.QuadPart = (LONGLONG)size;
+    bool truncated = SetFilePointerEx(file, end, nullptr, FILE_BEGIN) && SetEndOfFile(file);
+    CloseHandle(file);
+#else
+    bool truncated = ftruncate(_file, (off_t)size) == 0;
+    Close();
+#endif
+    if (!truncated) {
+        throw std::runtime_error("Error resizing file.");
+    }
+}
@@ -0,0 +1,81 @@
+#pragma once
+#include <cstddef>
+#include <cstdint>
+#include <filesystem>
+#include <span>
+#include <stdexcept>
+#include <type_traits>
+
+// Memory-mapped view over a whole file.
+// Typed views follow ReadFile<T> semantics: the element count is rounded up and the tail is zero.
+// Mappings are page-granular and the OS zero-fills the last page past EOF, so no copy is needed for that.
+class MappedFile {
+public:
+    enum class Mode {
+        Read,
+        ReadWrite
+    };
+
+    MappedFile() = default;
+    explicit MappedFile(const std::filesystem::path& filename, Mode mode = Mode::Read);
+    ~MappedFile();
+
+    MappedFile(MappedFile&& other) noexcept;
+    MappedFile& operator=(MappedFile&& other) noexcept;
+    MappedFile(const MappedFile&) = delete;
+    MappedFile& operator=(const MappedFile&) = delete;
+
+    template <typename T, typename = std::enable_if_t<std::is_integral_v<T>>>
+    std::span<const T> View() const {
+        return std::span<const T>(reinterpret_cast<const T*>(_data), RoundedCount<T>());
+    }
+
+    // Writes into the zero tail past EOF are not persisted
+    template <typename T, typename = std::enable_if_t<std::is_integral_v<T>>>
+    std::span<T> MutableView() {
+        if (_mode != Mode::ReadWrite) {
+            throw std::runtime_error("File is mapped read-only.");
+        }
+
+        return std::span<T>(reinterpret_cast<T*>(_data), RoundedCount<T>());
+    }
+
+    size_t Size() const {
+        return _size;
+    }
+
+    void Flush();
+    void Close();
+
+protected:
+    uint8_t* _data = nullptr;
+    size_t _size = 0;
+    Mode _mode = Mode::Read;
+#ifdef _WIN32
+    void* _file = nullptr;
+    void* _mapping = nullptr;
+#else
+    int _file = -1;
+#endif
+
+    void Map(const std::filesystem::path& filename, Mode mode, const size_t* resize);
+
+    template <typename T>
+    size_t RoundedCount() const {
+        return (_size + sizeof(T) - 1) / sizeof(T);
+    }
+};
+
+// Output file created with its final (or maximal) size upfront and filled through a mapping.
+// Commit() shrinks the file to the bytes actually produced.
+class MappedWriter : public MappedFile {
+public:
+    MappedWriter(const std::filesystem::path& filename, size_t size);
+
+    template <typename T, typename = std::enable_if_t<std::is_integral_v<T>>>
+    std::span<T> View() {
+        return std::span<T>(reinterpret_cast<T*>(_data), _size / sizeof(T));
+    }
+
+    void Commit(size_t size);
+};
@@ -0,0 +1,214 @@
+#include "Pipeline.h"
+#include <condition_variable>
+#include <exception>
+#include <fstream>
+#include <mutex>
+#include <queue>
+#include <stdexcept>
+#include <thread>
+
+namespace {
+    struct Chunk {
+        std::vector<uint8_t> data;
+        bool last = false;
+    };
+
+    class ChunkQueue {
+    public:
+        void Push(Chunk* chunk) {
+            {
+                std::lock_guard<std::mutex> lock(_mutex);
+                _chunks.push(chunk);
+            }
+
+            _condition.notify_one();
+        }
+
+        // Returns nullptr once the pipeline is aborted
+        Chunk* Pop() {
+            std::unique_lock<std::mutex> lock(_mutex);
+            _condition.wait(lock, [this]() { return _aborted || !_chunks.empty(); });
+            if (_aborted) {
+                return nullptr;
+            }
+
+            Chunk* chunk = _chunks.front();
+            _chunks.pop();
+            return chunk;
+        }
+
+        void Abort() {
+            {
+                std::lock_guard<std::mutex> lock(_mutex);
+                _aborted = true;
+            }
+
+            _condition.notify_all();
+        }
+
+    private:
+        std::queue<Chunk*> _chunks;
+        std::mutex _mutex;
+        std::condition_variable _condition;
+        bool _aborted = false;
+    };
+
+    class Pipeline {
+    public:
+        explicit Pipeline(const PipelineOptions& options)
+        : _inputChunks(options.bufferCount)
+        , _outputChunks(options.bufferCount)
+        , _chunkSize(options.chunkSize) {
+            if (options.bufferCount == 0 || options.chunkSize == 0) {
+                throw std::invalid_argument("Pipeline needs at least one non-empty buffer.");
+            }
+
+            for (Chunk& chunk : _inputChunks) {
+                chunk.data.reserve(_chunkSize);
+                _freeInput.Push(&chunk);
+            }
+
+            for (Chunk& chunk : _outputChunks) {
+                chunk.data.reserve(_chunkSize);
+                _freeOutput.Push(&chunk);
+            }
+        }
+
+        void Run(std::ifstream& input, std::ofstream& output, ChunkCodec& codec) {
+            std::thread reader([this, &input]() { Guard([this, &input]() { ReadLoop(input); }); });
+            std::thread writer([this, &output]() { Guard([this, &output]() { WriteLoop(output); }); });
+            Guard([this, &codec]() { TransformLoop(codec); });
+            reader.join();
+            writer.join();
+
+            if (_error) {
+                std::rethrow_exception(_error);
+            }
+        }
+
+    private:
+        std::vector<Chunk> _inputChunks;
+        std::vector<Chunk> _outputChunks;
+        size_t _chunkSize;
+        ChunkQueue _freeInput;
+        ChunkQueue _readyInput;
+        ChunkQueue _freeOutput;
+        ChunkQueue _readyOutput;
+        std::mutex _errorMutex;
+        std::exception_ptr _error;
+
+        template <typename F>
+        void Guard(F stage) {
+            try {
+                stage();
+            }
+            catch (...) {
+                {
+                    std::lock_guard<std::mutex> lock(_errorMutex);
+                    if (!_error) {
+                        _error = std::current_exception();
+                    }
+                }
+
+                // Wake every stage so nobody waits for a chunk that will never come
+                _freeInput.Abort();
+                _readyInput.Abort();
+                _freeOutput.Abort();
+                _readyOutput.Abort();
+            }
+        }
+
+        void ReadLoop(std::ifstream& input) {
+            while (Chunk* chunk = _freeInput.Pop()) {
+                chunk->data.resize(_chunkSize);
+                input.read(reinterpret_cast<char*>(chunk->data.data()), _chunkSize);
+                chunk->data.resize((size_t)input.gcount());
+                if (input.bad()) {
+                    throw std::runtime_error("Error reading file.");
+                }
+
+                chunk->last = input.eof();
+                _readyInput.Push(chunk);
+                if (chunk->last) {
+                    return;
+                }
+            }
+        }
+
+        void TransformLoop(ChunkCodec& codec) {
+            while (Chunk* chunk = _readyInput.Pop()) {
+                Chunk* result = _freeOutput.Pop();
+                if (result == nullptr) {
+                    return;
+                }
+
+                result->data.clear();
+                codec.Transform(chunk->data, result->data);
+                // Held back output goes out a chunk at a time
+                while (codec.HasPending()) {
+                    result->last = false;
+                    _readyOutput.Push(result);
+                    result = _freeOutput.Pop();
+                    if (result == nullptr) {
+                        return;
+                    }
+
+                    result->data.clear();
+                    codec.Drain(result->data);
+                }
+
+                result->last = chunk->last;
+                if (result->last) {
+                    codec.Finish(result->data);
+                }
+
+                _freeInput.Push(chunk);
+                _readyOutput.Push(result);
+                if (result->last) {
+                    return;
+                }
+            }
+        }
+
+        void WriteLoop(std::ofstream& output) {
+            while (Chunk* chunk = _readyOutput.Pop()) {
+                if (!output.write(reinterpret_cast<const char*>(chunk->data.data()), chunk->data.size())) {
+                    throw std::runtime_error("Error writing to file.");
+                }
+
+                if (chunk->last) {
+                    return;
+                }
+
+                _freeOutput.Push(chunk);
+            }
+        }
+    };
+}
+
+void RunPipeline(const std::filesystem::path& input, const std::filesystem::path& output, ChunkCodec& codec,
+    const PipelineOptions& options) {
+    std::ifstream inputStream(input, std::ios::binary);
+    if (!inputStream.is_open()) {
+        throw std::runtime_error("Error opening file.");
+    }
+
+    // Truncating the output would wipe the input before it is read
+    std::error_code error;
+    if (std::filesystem::equivalent(input, output, error)) {
+        throw std::runtime_error("Input and output are the same file.");
+    }
+
+    std::ofstream outputStream(output, std::ios::binary | std::ios::trunc);
+    if (!outputStream.is_open()) {
+        throw std::runtime_error("Error opening file for writing.");
+    }
+
+    Pipeline pipeline(options);
+    pipeline.Run(inputStream, outputStream, codec);
+    // The tail may still sit in the stream buffer, a failed flush must not pass as success
+    outputStream.close();
+    if (outputStream.fail()) {
+        throw std::runtime_error("Error writing to file.");
+    }
+}
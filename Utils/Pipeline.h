@@ -0,0 +1,43 @@
+#pragma once
+#include <cstddef>
+#include <cstdint>
+#include <filesystem>
+#include <span>
+#include <vector>
+
+// Chunk-wise transform driven by RunPipeline. Chunk boundaries are arbitrary,
+// so codecs that work on larger units have to carry the remainder over themselves.
+class ChunkCodec {
+public:
+    virtual ~ChunkCodec() = default;
+
+    // Appends the transformed form of input to output
+    virtual void Transform(std::span<const uint8_t> input, std::vector<uint8_t>& output) = 0;
+
+    // Codecs whose output can outgrow their input hold the excess back. While HasPending,
+    // the pipeline calls Drain with a fresh output chunk before the next Transform or Finish.
+    virtual bool HasPending() const {
+        return false;
+    }
+
+    virtual void Drain(std::vector<uint8_t>& output) {
+    }
+
+    // Called once after the last chunk to flush anything still buffered
+    virtual void Finish(std::vector<uint8_t>& output) {
+    }
+};
+
+struct PipelineOptions {
+    size_t chunkSize = 1 << 20;
+    // Buffers per direction: 2 is double buffering, 3 lets the reader run a full chunk ahead
+    size_t bufferCount = 3;
+};
+
+// Streams input through codec into output: a reader thread fills recycled chunks, the calling thread
+// transforms them and a writer thread drains the results. Each stage blocks when it runs out of free
+// buffers, so memory stays at 2 * bufferCount chunks and throughput is bound by the slowest stage.
+// Output chunks are only as small as the codec keeps them, see ChunkCodec::HasPending.
+// Input and output must be different files, the output is truncated before anything is read.
+void RunPipeline(const std::filesystem::path& input, const std::filesystem::path& output, ChunkCodec& codec,
+    const PipelineOptions& options = PipelineOptions());
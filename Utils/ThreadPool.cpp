@@ -0,0 +1,58 @@
+#include "ThreadPool.h"
+#include <algorithm>
+
+ThreadPool::ThreadPool(size_t threadCount) {
+    threadCount = std::max<size_t>(threadCount, 1);
+    _workers.reserve(threadCount);
+    for (size_t i = 0; i < threadCount; ++i) {
+        _workers.emplace_back(&ThreadPool::WorkerLoop, this);
+    }
+}
+
+ThreadPool::~ThreadPool() {
+    {
+        std::lock_guard<std::mutex> lock(_mutex);
+        _stopping = true;
+    }
+
+    _condition.notify_all();
+    for (std::thread& worker : _workers) {
+        worker.join();
+    }
+}
+
+void ThreadPool::WorkerLoop() {
+    while (true) {
+        std::function<void()> task;
+        {
+            std::unique_lock<std::mutex> lock(_mutex);
+            _condition.wait(lock, [this]() { return _stopping || !_tasks.empty(); });
+            // Drain the queue before stopping so no submitted future is left unsatisfied
+            if (_tasks.empty()) {
+                return;
+            }
+
+            task = std::move(_tasks.front());
+            _tasks.pop();
+        }
+
+        task();
+    }
+}
+
+size_t MemoryBudget::Acquire(size_t bytes) {
+    bytes = std::min(bytes, _capacity);
+    std::unique_lock<std::mutex> lock(_mutex);
+    _condition.wait(lock, [this, bytes]() { return _available >= bytes; });
+    _available -= bytes;
+    return bytes;
+}
+
+void MemoryBudget::Release(size_t bytes) {
+    {
+        std::lock_guard<std::mutex> lock(_mutex);
+        _available += bytes;
+    }
+
+    _condition.notify_all();
+}
@@ -0,0 +1,66 @@
+#pragma once
+#include <condition_variable>
+#include <cstddef>
+#include <functional>
+#include <future>
+#include <memory>
+#include <mutex>
+#include <queue>
+#include <thread>
+#include <type_traits>
+#include <vector>
+
+class ThreadPool {
+public:
+    explicit ThreadPool(size_t threadCount = std::thread::hardware_concurrency());
+    ~ThreadPool();
+
+    ThreadPool(const ThreadPool&) = delete;
+    ThreadPool& operator=(const ThreadPool&) = delete;
+
+    template <typename F>
+    auto Submit(F&& task) -> std::future<std::invoke_result_t<std::decay_t<F>>> {
+        using R = std::invoke_result_t<std::decay_t<F>>;
+        auto packaged = std::make_shared<std::packaged_task<R()>>(std::forward<F>(task));
+        std::future<R> result = packaged->get_future();
+        {
+            std::lock_guard<std::mutex> lock(_mutex);
+            _tasks.emplace([packaged]() { (*packaged)(); });
+        }
+
+        _condition.notify_one();
+        return result;
+    }
+
+    size_t GetThreadCount() const {
+        return _workers.size();
+    }
+
+private:
+    std::vector<std::thread> _workers;
+    std::queue<std::function<void()>> _tasks;
+    std::mutex _mutex;
+    std::condition_variable _condition;
+    bool _stopping = false;
+
+    void WorkerLoop();
+};
+
+// Blocking byte budget used to bound the amount of data held by in-flight tasks
+class MemoryBudget {
+public:
+    explicit MemoryBudget(size_t capacity)
+    : _capacity(capacity)
+    , _available(capacity) {
+    }
+
+    // Requests larger than the whole budget are clamped, so they run alone instead of deadlocking
+    size_t Acquire(size_t bytes);
+    void Release(size_t bytes);
+
+private:
+    size_t _capacity;
+    size_t _available;
+    std::mutex _mutex;
+    std::condition_variable _condition;
+};
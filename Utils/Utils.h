@@ -1,11 +1,15 @@
 #pragma once
 #include <vector>
 #include <string>
+#include <cstring>
+#include <filesystem>
 #include <fstream>
+#include <span>
 #include <stdexcept>
+#include "MappedFile.h"
 
 template <typename T, typename = std::enable_if_t<std::conjunction_v<std::is_integral<T>>>>
-std::vector<T> ReadFile(const std::wstring& filename) {
+std::vector<T> ReadFile(const std::filesystem::path& filename) {
     std::ifstream input(filename, std::ios::binary);
     if (!input.is_open()) {
         throw std::runtime_error("Error opening file.");
@@ -28,7 +32,7 @@ std::vector<T> ReadFile(const std::wstring& filename) {
 }
 
 template <typename T, typename = std::enable_if_t<std::conjunction_v<std::is_integral<T>>>>
-void WriteFile(const std::wstring& filename, const std::vector<T>& data) {
+void WriteFile(const std::filesystem::path& filename, std::span<const T> data) {
     std::ofstream output(filename, std::ios::binary | std::ios::trunc);
     if (!output.is_open()) {
         throw std::runtime_error("Error opening file for writing.");
@@ -39,6 +43,11 @@ void WriteFile(const std::wstring& filename, const std::vector<T>& data) {
     }
 }
 
+template <typename T, typename = std::enable_if_t<std::conjunction_v<std::is_integral<T>>>>
+void WriteFile(const std::filesystem::path& filename, const std::vector<T>& data) {
+    WriteFile(filename, std::span<const T>(data));
+}
+
 template <typename T, typename F,
     typename = std::enable_if_t<std::conjunction_v<std::is_integral<T>, std::is_unsigned<T>, std::is_integral<F>, std::is_unsigned<F>>>>
     std::vector<T> VecConvert(const F* data, size_t length) {